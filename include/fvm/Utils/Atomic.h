@@ -0,0 +1,63 @@
+#ifndef UTILS_ATOMIC_H_
+#define UTILS_ATOMIC_H_
+
+#include <stdint.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+/* Sequentially consistent atomic operations on plain (naturally aligned) memory,
+   for buffers that can't be declared as std::atomic such as the guest's RAM */
+
+template<typename T>
+static inline bool atomicCompareExchange(T * ptr, T & expected, T desired)
+{
+#ifdef _MSC_VER
+	T old;
+	switch (sizeof(T)) {
+	case 1:  old = (T)_InterlockedCompareExchange8((volatile char*)ptr, (char)desired, (char)expected); break;
+	case 2:  old = (T)_InterlockedCompareExchange16((volatile short*)ptr, (short)desired, (short)expected); break;
+	case 4:  old = (T)_InterlockedCompareExchange((volatile long*)ptr, (long)desired, (long)expected); break;
+	default: old = (T)_InterlockedCompareExchange64((volatile long long*)ptr, (long long)desired, (long long)expected); break;
+	}
+	bool success = old == expected;
+	expected = old;
+	return success;
+#else
+	return __atomic_compare_exchange_n(ptr, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+#endif
+}
+
+
+template<typename T>
+static inline T atomicExchange(T * ptr, T desired)
+{
+#ifdef _MSC_VER
+	switch (sizeof(T)) {
+	case 1:  return (T)_InterlockedExchange8((volatile char*)ptr, (char)desired);
+	case 2:  return (T)_InterlockedExchange16((volatile short*)ptr, (short)desired);
+	case 4:  return (T)_InterlockedExchange((volatile long*)ptr, (long)desired);
+	default: return (T)_InterlockedExchange64((volatile long long*)ptr, (long long)desired);
+	}
+#else
+	return __atomic_exchange_n(ptr, desired, __ATOMIC_SEQ_CST);
+#endif
+}
+
+/* Returns the value from before the addition */
+template<typename T>
+static inline T atomicFetchAdd(T * ptr, T addend)
+{
+#ifdef _MSC_VER
+	switch (sizeof(T)) {
+	case 1:  return (T)_InterlockedExchangeAdd8((volatile char*)ptr, (char)addend);
+	case 2:  return (T)_InterlockedExchangeAdd16((volatile short*)ptr, (short)addend);
+	case 4:  return (T)_InterlockedExchangeAdd((volatile long*)ptr, (long)addend);
+	default: return (T)_InterlockedExchangeAdd64((volatile long long*)ptr, (long long)addend);
+	}
+#else
+	return __atomic_fetch_add(ptr, addend, __ATOMIC_SEQ_CST);
+#endif
+}
+
+#endif
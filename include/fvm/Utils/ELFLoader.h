@@ -3,18 +3,51 @@
 
 #include <fvm/Utils/IO/File.h>
 #include <vector>
-#include <bitset>
+#include <stdint.h>
 
 typedef struct {
 	uint32_t    start; /* Byte aligned        */
-	uint32_t    end;   /* Byte aligned        */
+	uint32_t    end;   /* Byte aligned (one past the last byte) */
 	std::string name;  /* Name of the section */
 	bool        isLittleEndian; /* Indicates whether this section contains big (0) or little (1) endian data */
 } elfsection_t;
 
 typedef std::vector<elfsection_t> elfsection_list_t;
 
+typedef struct {
+	uint32_t    address; /* Where the symbol was loaded */
+	uint32_t    size;    /* Size of the object / function (0 if unknown) */
+	std::string name;
+	bool        isFunction;
+} elfsymbol_t;
+
+typedef std::vector<elfsymbol_t> elfsymbol_list_t;
+
+/* What was loaded out of an ELF file. Both lists are sorted by address */
+typedef struct {
+	uint32_t          entry;    /* Where execution starts */
+	uint32_t          end;      /* One past the highest loaded byte */
+	elfsection_list_t sections; /* Every allocated section (.text, .rodata, .data, .bss, ...) */
+	elfsymbol_list_t  symbols;  /* Every named function and object */
+} elfimage_t;
+
+/* Cheap check on the first bytes of an image, before handing it to the ELF parser */
+inline bool isImageELF(const uint8_t * image, uint64_t size)
+{
+	return size >= 4 && image[0] == 0x7F && image[1] == 'E' && image[2] == 'L' && image[3] == 'F';
+}
+
 bool isFileELF(File & file);
-uint32_t elfToFlatBinary(std::vector<std::bitset<8> > & loadedELF, elfsection_list_t & elfsection_list, bool textIsLittle, bool dataIsLittle);
+
+/* Places every PT_LOAD segment of the ELF file at its physical address (zero filling the
+   part that isn't backed by the file, e.g. .bss) and fills in the image description.
+   Object files without program headers get their .text and .data packed from address 0.
+   Passing a null memory only fills in the image (the memory size needed is image.end) */
+bool elfLoad(uint8_t * memory, uint64_t memorySize, elfimage_t & image, bool textIsLittle, bool dataIsLittle);
+
+/* Lookups on the image's indices (nullptr if nothing matches) */
+const elfsection_t * elfFindSection(const elfimage_t & image, uint32_t address);
+const elfsymbol_t * elfFindSymbol(const elfimage_t & image, uint32_t address);  /* The symbol the address falls in */
+const elfsymbol_t * elfFindSymbol(const elfimage_t & image, std::string name);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef UTILS_ENDIAN_H_
+#define UTILS_ENDIAN_H_
+
+#include <stdint.h>
+#include <string.h>
+#ifdef _MSC_VER
+#include <stdlib.h>
+#endif
+
+/* Byte order of the host */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define HOST_IS_LITTLE_ENDIAN 0
+#else
+#define HOST_IS_LITTLE_ENDIAN 1
+#endif
+
+/* Byte swaps (each one compiles down to a single bswap / rev instruction) */
+static inline uint8_t byteSwap(uint8_t val)
+{
+	return val;
+}
+
+static inline uint16_t byteSwap(uint16_t val)
+{
+#ifdef _MSC_VER
+	return _byteswap_ushort(val);
+#else
+	return __builtin_bswap16(val);
+#endif
+}
+
+static inline uint32_t byteSwap(uint32_t val)
+{
+#ifdef _MSC_VER
+	return _byteswap_ulong(val);
+#else
+	return __builtin_bswap32(val);
+#endif
+}
+
+static inline uint64_t byteSwap(uint64_t val)
+{
+#ifdef _MSC_VER
+	return _byteswap_uint64(val);
+#else
+	return __builtin_bswap64(val);
+#endif
+}
+
+/* Loads / stores a T from / to a byte buffer in the given byte order. The memcpy
+   is there for the strict aliasing rules and for unaligned addresses, the compiler
+   turns it into a single host load / store */
+template<typename T>
+static inline T loadEndian(const uint8_t * src, bool isLittleEndian)
+{
+	T val;
+	memcpy(&val, src, sizeof(T));
+	return isLittleEndian == (HOST_IS_LITTLE_ENDIAN != 0) ? val : byteSwap(val);
+}
+
+template<typename T>
+static inline void storeEndian(uint8_t * dst, T val, bool isLittleEndian)
+{
+	if (isLittleEndian != (HOST_IS_LITTLE_ENDIAN != 0))
+		val = byteSwap(val);
+	memcpy(dst, &val, sizeof(T));
+}
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef UTILS_HASH_H_
+#define UTILS_HASH_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* 64-bit FNV-1a hash */
+#define FNV1A64_OFFSET 0xCBF29CE484222325ULL
+#define FNV1A64_PRIME  0x00000100000001B3ULL
+
+static inline uint64_t fnv1a64Byte(uint64_t hash, uint8_t byte)
+{
+	return (hash ^ byte) * FNV1A64_PRIME;
+}
+
+static inline uint64_t fnv1a64(const void * data, size_t size, uint64_t hash = FNV1A64_OFFSET)
+{
+	const uint8_t * bytes = (const uint8_t*)data;
+	for (size_t i = 0; i < size; i++)
+		hash = fnv1a64Byte(hash, bytes[i]);
+	return hash;
+}
+
+#endif
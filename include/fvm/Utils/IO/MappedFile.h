@@ -0,0 +1,33 @@
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <string>
+#include <stdint.h>
+#include <stddef.h>
+
+/* A read only view of a whole file, mapped straight into the address space.
+   The file's bytes are only paged in by the host as they are accessed */
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile & operator=(const MappedFile &) = delete;
+
+	bool map(std::string fileName);
+	void unmap();
+
+	bool isMapped();
+	const uint8_t * data();
+	uint64_t size();
+private:
+	const uint8_t * base;
+	uint64_t bytes;
+#ifdef _WIN32
+	void * fileHandle;
+	void * mappingHandle;
+#endif
+};
+
+#endif
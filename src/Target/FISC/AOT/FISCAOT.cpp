@@ -0,0 +1,362 @@
+/*
+  fisc-aot: the ahead-of-time translator of FISC programs.
+
+  Loads a program exactly like the Memory Module does (flat binaries as they are, ELF objects
+  through the ELF loader), splits its code into basic blocks and lifts each block into a C++
+  function. The output is a single C++ file that gets built into a shared library, which the
+  VM then loads with --aot=<library> (see fisc_aot_library() in this directory's CMakelists).
+
+  Usage: fisc-aot <program> <output.cpp>
+
+  The simple integer instructions (ALU without flags, shifts, MOVZ / MOVK) are lifted into
+  straight C++ on the guest registers, which the translated code reads and writes in place. Everything else is handed back to the interpreter one
+  instruction at a time, so the translated code never has to know about memory, the MMU,
+  the flags, exceptions or interrupts.
+*/
+
+#include <fvm/Utils/ELFLoader.h>
+#include <fvm/Utils/IO/MappedFile.h>
+#include <fvm/Utils/Hash.h>
+#include "../CPU/ISA/FISCISA.h"
+#include "../CPU/FISCCPUAOT.h"
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <set>
+#include <fstream>
+#include <iterator>
+
+/* Which instructions the translator knows about. This has to match the NEW_INSTRUCTION
+   declarations of the CPU (under CPU/ISA) so that every word decodes the same way it does there */
+typedef struct {
+    enum OPCODE opcode;
+    enum INSTRUCTION_FMT format;
+    const char * mnemonic;
+} aot_instruction_t;
+
+static const aot_instruction_t aot_instructions[] = {
+    { ADD,   RF,  "ADD"   }, { ADDI,  IF,  "ADDI"  }, { ADDIS,  IF,  "ADDIS"  }, { ADDS,  RF,  "ADDS"  },
+    { SUB,   RF,  "SUB"   }, { SUBI,  IF,  "SUBI"  }, { SUBIS,  IF,  "SUBIS"  }, { SUBS,  RF,  "SUBS"  },
+    { MUL,   RF,  "MUL"   }, { SMULH, RF,  "SMULH" }, { UMULH,  RF,  "UMULH"  },
+    { SDIV,  RF,  "SDIV"  }, { UDIV,  RF,  "UDIV"  },
+    { AND,   RF,  "AND"   }, { ANDI,  IF,  "ANDI"  }, { ANDIS,  IF,  "ANDIS"  }, { ANDS,  RF,  "ANDS"  },
+    { ORR,   RF,  "ORR"   }, { ORRI,  IF,  "ORRI"  },
+    { EOR,   RF,  "EOR"   }, { EORI,  IF,  "EORI"  },
+    { NEG,   RF,  "NEG"   }, { NEGI,  IF,  "NEGI"  },
+    { NOT,   RF,  "NOT"   }, { NOTI,  IF,  "NOTI"  },
+    { LSL,   RF,  "LSL"   }, { LSR,   RF,  "LSR"   },
+    { B,     BF,  "B"     }, { BL,    BF,  "BL"    },
+    { BR,    RF,  "BR"    }, { BRL,   RF,  "BRL"   },
+    { BCOND, CBF, "BCOND" }, { CBNZ,  CBF, "CBNZ"  }, { CBZ,    CBF, "CBZ"    },
+    { MOVZ,  IWF, "MOVZ"  }, { MOVK,  IWF, "MOVK"  }, { MOVRZ,  IWF, "MOVRZ"  }, { MOVRK, IWF, "MOVRK" },
+    { LDPC,  RF,  "LDPC"  },
+    { LDR,   DF,  "LDR"   }, { LDRB,  DF,  "LDRB"  }, { LDRH,   DF,  "LDRH"   }, { LDRSW,  DF, "LDRSW"  }, { LDXR,  DF, "LDXR"  },
+    { LDRR,  DF,  "LDRR"  }, { LDRBR, DF,  "LDRBR" }, { LDRHR,  DF,  "LDRHR"  }, { LDRSWR, DF, "LDRSWR" }, { LDXRR, DF, "LDXRR" },
+    { STR_,  DF,  "STR"   }, { STRB,  DF,  "STRB"  }, { STRH,   DF,  "STRH"   }, { STRW,   DF, "STRW"   }, { STXR,  DF, "STXR"  },
+    { STRR,  DF,  "STRR"  }, { STRBR, DF,  "STRBR" }, { STRHR,  DF,  "STRHR"  }, { STRWR,  DF, "STRWR"  }, { STXRR, DF, "STXRR" },
+    { FADDS, RF,  "FADDS" }, { FADDD, RF,  "FADDD" }, { FSUBS,  RF,  "FSUBS"  }, { FSUBD, RF,  "FSUBD" },
+    { FCMPS, RF,  "FCMPS" }, { FCMPD, RF,  "FCMPD" }, { FMULS,  RF,  "FMULS"  }, { FMULD, RF,  "FMULD" },
+    { FDIVS, RF,  "FDIVS" }, { FDIVD, RF,  "FDIVD" }, { LDRS,   RF,  "LDRS"   }, { LDRD,  RF,  "LDRD"  },
+    { STRS,  RF,  "STRS"  }, { STRD,  RF,  "STRD"  },
+    { MSR,   RF,  "MSR"   }, { MRS,   RF,  "MRS"   },
+    { LIVP,  RF,  "LIVP"  }, { SIVP,  RF,  "SIVP"  }, { LEVP,   RF,  "LEVP"   }, { SEVP,  RF,  "SEVP"  },
+    { SESR,  RF,  "SESR"  }, { SINT,  BF,  "SINT"  }, { RETI,   BF,  "RETI"   },
+    { LPDP,  RF,  "LPDP"  }, { SPDP,  RF,  "SPDP"  }, { LPFLA,  RF,  "LPFLA"  },
+    { SCID,  RF,  "SCID"  }, { SIPI,  RF,  "SIPI"  },
+    { CAS,   RF,  "CAS"   }, { LDADD, RF,  "LDADD" }, { SWP,    RF,  "SWP"    }, { DMBA,   RF, "DMBA"   }, { DMBR,  RF, "DMBR"  }
+};
+
+#define AOT_INSTRUCTION_COUNT (sizeof(aot_instructions) / sizeof(aot_instructions[0]))
+
+/* Same expansion the CPU Configurator does (see CPUConfigurator::buildOpcodeTable()) */
+static const aot_instruction_t * opcode_table[FISC_OPCODE_TABLE_SZ];
+
+static unsigned opcodeSize(enum INSTRUCTION_FMT format)
+{
+    switch (format) {
+        case IFMT_R:  return 11;
+        case IFMT_I:  return 10;
+        case IFMT_D:  return 11;
+        case IFMT_B:  return 6;
+        case IFMT_CB: return 8;
+        case IFMT_IW: return 9;
+        default:      return 0;
+    }
+}
+
+static void buildOpcodeTable()
+{
+    const aot_instruction_t * branchInstruction = nullptr;
+
+    for (unsigned i = 0; i < AOT_INSTRUCTION_COUNT; i++) {
+        const aot_instruction_t * instr = &aot_instructions[i];
+        unsigned size = opcodeSize(instr->format);
+        unsigned dontCareBits = FISC_OPCODE_SZ - size;
+        unsigned firstSlot = ((unsigned)instr->opcode >> (11 - size)) << dontCareBits;
+        unsigned lastSlot = firstSlot + (1 << dontCareBits);
+
+        for (unsigned slot = firstSlot; slot < lastSlot && slot < FISC_OPCODE_TABLE_SZ; slot++)
+            if (opcode_table[slot] == nullptr || opcodeSize(opcode_table[slot]->format) < size)
+                opcode_table[slot] = instr;
+
+        if (instr->opcode == B)
+            branchInstruction = instr;
+    }
+
+    for (unsigned slot = (B << 1); slot < (B << 1) + (1 << (FISC_OPCODE_SZ - 6)); slot++)
+        opcode_table[slot] = branchInstruction;
+}
+
+static const aot_instruction_t * decode(uint32_t instruction)
+{
+    if (instruction == (uint32_t)-1)
+        return nullptr;
+    return opcode_table[OPCODE_MASK(instruction)];
+}
+
+/* Same as CPUModule::endsBlock */
+static bool endsBlock(enum OPCODE opcode)
+{
+    switch (opcode) {
+        case B: case BL: case BR: case BRL: case BCOND: case CBZ: case CBNZ:
+        case SINT: case RETI: case MSR: case LPDP:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Sign extends the lowest 'bits' bits of 'value' */
+static int64_t signExtend(uint32_t value, unsigned bits)
+{
+    return (int64_t)((uint64_t)value << (64 - bits)) >> (64 - bits);
+}
+
+/* The target of a direct branch, if the instruction is one */
+static bool branchTarget(const aot_instruction_t * instr, uint32_t instruction, uint32_t address, uint32_t & target)
+{
+    switch (instr->opcode) {
+        case B: case BL:
+            target = address + (uint32_t)signExtend(instrBrAddr(instruction), 26);
+            return true;
+        case BCOND: case CBZ: case CBNZ:
+            target = address + (uint32_t)signExtend(instrCondBrAddr(instruction), 19);
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Writes the C++ statement that runs the instruction inline. Returns false if it has to be interpreted */
+static bool lift(FILE * out, const aot_instruction_t * instr, uint32_t instruction)
+{
+    unsigned rd    = instrRd(instruction); /* R, I: Rd | IW: Rt */
+    unsigned rn    = instrRn(instruction);
+    unsigned shamt = instrShamt(instruction);
+    unsigned rm    = instrRm(instruction);
+    long long aluImm = (long long)signExtend(instrALUImm(instruction), 12);
+    unsigned long long movImm = instrMOVImm(instruction);
+    unsigned quadrant = instrQuadrant(instruction);
+    const char * op = nullptr;
+
+    if (rd == XZR) {
+        /* The registers are written directly, so writes to XZR (which have no effect) are dropped here */
+        switch (instr->opcode) {
+            case ADD: case ADDI: case SUB: case SUBI: case AND: case ANDI: case ORR: case ORRI:
+            case EOR: case EORI: case LSL: case LSR: case NOT: case MOVZ: case MOVK:
+                fprintf(out, ";");
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    switch (instr->opcode) {
+        case ADD:  case ADDI: op = "+"; break;
+        case SUB:  case SUBI: op = "-"; break;
+        case AND:  case ANDI: op = "&"; break;
+        case ORR:  case ORRI: op = "|"; break;
+        case EOR:  case EORI: op = "^"; break;
+        case LSL: fprintf(out, "W(%u, R(%u) << %u);", rd, rn, shamt); return true;
+        case LSR: fprintf(out, "W(%u, R(%u) >> %u);", rd, rn, shamt); return true;
+        case NOT: fprintf(out, "W(%u, ~R(%u));", rd, rn); return true;
+        case MOVZ:
+            fprintf(out, "W(%u, 0x%llXULL);", rd, movImm << (16 * quadrant));
+            return true;
+        case MOVK:
+            fprintf(out, "W(%u, (R(%u) & 0x%016llXULL) | 0x%llXULL);", rd, rd, ~(0xFFFFULL << (16 * quadrant)), movImm << (16 * quadrant));
+            return true;
+        default:
+            return false;
+    }
+
+    if (instr->format == IFMT_R)
+        fprintf(out, "W(%u, R(%u) %s R(%u));", rd, rn, op, rm);
+    else
+        fprintf(out, "W(%u, R(%u) %s (uint64_t)%lldLL);", rd, rn, op, aluImm);
+    return true;
+}
+
+static bool loadProgram(const char * path, std::vector<uint8_t> & image, uint32_t & codeStart, uint32_t & codeEnd, uint64_t & programHash)
+{
+    MappedFile file;
+    if (!file.map(path))
+        return false;
+    image.assign(file.data(), file.data() + file.size());
+
+    /* Hashed before relocation, exactly like MemoryModule::loadMemory() does */
+    programHash = fnv1a64(file.data(), (size_t)file.size());
+
+    codeStart = 0;
+    codeEnd = (uint32_t)image.size();
+
+    File programFile(path, std::ios::in | std::ios::binary);
+    if (isImageELF(file.data(), file.size()) && isFileELF(programFile)) {
+        /* Lay it out first to find out how much memory it spans, then load it for real */
+        elfimage_t elfImage;
+        if (!elfLoad(nullptr, 0, elfImage, ENDIANNESS_TEXTSECT, ENDIANNESS_DATASECT) || elfImage.end == 0)
+            return false;
+        image.assign(elfImage.end, 0);
+        if (!elfLoad(image.data(), image.size(), elfImage, ENDIANNESS_TEXTSECT, ENDIANNESS_DATASECT))
+            return false;
+        codeEnd = elfImage.end;
+
+        /* Only the code gets translated */
+        for (auto & section : elfImage.sections) {
+            if (section.name == ".text") {
+                codeStart = section.start;
+                codeEnd = section.end;
+            }
+        }
+    }
+
+    return true;
+}
+
+static uint32_t readWord(std::vector<uint8_t> & image, uint32_t address)
+{
+    /* The text section is big endian (ENDIANNESS_TEXTSECT) */
+    uint32_t word = 0;
+    for (uint32_t i = 0; i < FISC_INSTRUCTION_SZ / 8; i++)
+        word = (word << 8) | image[address + i];
+    return word;
+}
+
+int main(int argc, char ** argv)
+{
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <program> <output.cpp>\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> image;
+    uint32_t codeStart = 0, codeEnd = 0;
+    uint64_t programHash = 0;
+
+    if (!loadProgram(argv[1], image, codeStart, codeEnd, programHash)) {
+        fprintf(stderr, "fisc-aot: could not load the program '%s'\n", argv[1]);
+        return 1;
+    }
+
+    buildOpcodeTable();
+
+    const uint32_t instrSize = FISC_INSTRUCTION_SZ / 8;
+    codeStart = (codeStart + instrSize - 1) & ~(instrSize - 1);
+    codeEnd &= ~(instrSize - 1);
+
+    /* Find the leaders: the entry point, whatever follows the end of a block, the targets
+       of the direct branches and the start of every page (the VM never lets a block cross one) */
+    std::set<uint32_t> leaders;
+    for (uint32_t address = codeStart; address < codeEnd; address += instrSize) {
+        uint32_t instruction = readWord(image, address);
+        const aot_instruction_t * instr = decode(instruction);
+        uint32_t target = 0;
+
+        if (address == codeStart || address % FISC_PAGE_SIZE == 0)
+            leaders.insert(address);
+
+        if (instr == nullptr)
+            continue;
+        if (endsBlock(instr->opcode) && address + instrSize < codeEnd)
+            leaders.insert(address + instrSize);
+        if (branchTarget(instr, instruction, address, target) && target >= codeStart && target < codeEnd && !(target & (instrSize - 1)))
+            leaders.insert(target);
+    }
+
+    FILE * out = fopen(argv[2], "w");
+    if (out == nullptr) {
+        fprintf(stderr, "fisc-aot: could not create '%s'\n", argv[2]);
+        return 1;
+    }
+
+    fprintf(out, "/* Translated by fisc-aot from '%s'. Do not edit */\n\n", argv[1]);
+    fprintf(out, "#define FISC_AOT_LIBRARY\n");
+    fprintf(out, "#include <Target/FISC/CPU/FISCCPUAOT.h>\n\n");
+    fprintf(out, "#define R(reg)      (*bank[reg])\n");
+    fprintf(out, "#define W(reg, val) (*bank[reg] = (val))\n");
+    fprintf(out, "#define ADVANCE(n)  do { api->advance(cpu, n); *instructionsExecuted += n; } while(0)\n");
+    fprintf(out, "#define STEP()      do { uint32_t reason = api->step(cpu, instructionsExecuted); if (reason != FISC_AOT_CONTINUE) return reason; bank = *registers; } while(0)\n\n");
+
+    std::vector<std::pair<uint32_t, uint32_t> > blocks; /* Address and length */
+
+    for (auto it = leaders.begin(); it != leaders.end(); ++it) {
+        uint32_t start = *it;
+        uint32_t next = std::next(it) == leaders.end() ? codeEnd : *std::next(it);
+        uint32_t length = 0;
+        unsigned pending = 0; /* Lifted instructions the PC has not been advanced over yet */
+
+        fprintf(out, "static uint32_t block_%08X(void * cpu, const fisc_aot_api_t * api, fisc_aot_registers_t registers, uint32_t * instructionsExecuted)\n{\n", start);
+        fprintf(out, "    uint64_t ** bank = *registers;\n");
+
+        for (uint32_t address = start; address < next; address += instrSize) {
+            uint32_t instruction = readWord(image, address);
+            const aot_instruction_t * instr = decode(instruction);
+            length++;
+
+            if (instr != nullptr && instr->opcode == BL && (instruction & 0x3FFFFFF) == 0) {
+                /* BL 0 halts the CPU. The VM takes care of it */
+                if (pending)
+                    fprintf(out, "    ADVANCE(%u);\n", pending);
+                fprintf(out, "    return FISC_AOT_EXIT_HALT; /* 0x%08X: BL 0 */\n}\n\n", address);
+                pending = 0;
+                break;
+            }
+
+            fprintf(out, "    ");
+            if (instr != nullptr && lift(out, instr, instruction)) {
+                pending++;
+            }
+            else {
+                if (pending)
+                    fprintf(out, "ADVANCE(%u); ", pending);
+                fprintf(out, "STEP();");
+                pending = 0;
+            }
+            fprintf(out, " /* 0x%08X: %s (0x%08X) */\n", address, instr ? instr->mnemonic : "<UNDEFINED>", instruction);
+
+            if (address + instrSize == next) {
+                if (pending)
+                    fprintf(out, "    ADVANCE(%u);\n", pending);
+                fprintf(out, "    return FISC_AOT_EXIT_BLOCK;\n}\n\n");
+            }
+        }
+
+        blocks.push_back(std::make_pair(start, length));
+    }
+
+    fprintf(out, "extern \"C\" {\n\n");
+    fprintf(out, "const uint32_t fisc_aot_abi_version = FISC_AOT_ABI_VERSION;\n");
+    fprintf(out, "const uint64_t fisc_aot_program_hash = 0x%016llXULL;\n", (unsigned long long)programHash);
+    fprintf(out, "const uint32_t fisc_aot_block_count = %u;\n", (unsigned)blocks.size());
+    fprintf(out, "const fisc_aot_block_t fisc_aot_blocks[] = {\n");
+    for (auto & block : blocks)
+        fprintf(out, "    { 0x%08X, %u, block_%08X },\n", block.first, block.second, block.first);
+    if (blocks.empty())
+        fprintf(out, "    { 0, 0, nullptr }\n");
+    fprintf(out, "};\n\n}\n");
+
+    fclose(out);
+
+    printf("fisc-aot: translated %u blocks of '%s' into '%s'\n", (unsigned)blocks.size(), argv[1], argv[2]);
+    return 0;
+}
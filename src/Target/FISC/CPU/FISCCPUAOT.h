@@ -0,0 +1,75 @@
+#ifndef FISCCPUAOT_H_
+#define FISCCPUAOT_H_
+
+#include <stdint.h>
+
+/*****************************************************/
+/* Ahead-of-time translated programs (fisc-aot ABI)  */
+/*****************************************************/
+
+/* fisc-aot lifts the code of a FISC program into C++ (one function per basic block),
+   which is then built into a shared library that the VM loads with --aot=<library>.
+   This header is all the generated code gets to see of the VM, so it only uses plain
+   C types and it stays out of the FISC namespace. Bump the ABI version whenever
+   anything in here changes */
+
+#define FISC_AOT_ABI_VERSION 2
+
+#if defined(_WIN32)
+#define FISC_AOT_EXPORT __declspec(dllexport)
+#else
+#define FISC_AOT_EXPORT __attribute__((visibility("default")))
+#endif
+
+/* The symbols every translated library exports */
+#define FISC_AOT_SYMBOL_ABI_VERSION  "fisc_aot_abi_version"
+#define FISC_AOT_SYMBOL_PROGRAM_HASH "fisc_aot_program_hash"
+#define FISC_AOT_SYMBOL_BLOCK_COUNT  "fisc_aot_block_count"
+#define FISC_AOT_SYMBOL_BLOCKS       "fisc_aot_blocks"
+
+/* What a translated block (or a single interpreted instruction) returns */
+enum FISC_AOT_EXIT {
+    FISC_AOT_CONTINUE,   /* Keep going (only ever returned by step())                                               */
+    FISC_AOT_EXIT_BLOCK, /* The block is over (it ran to its end or hit a branch, an exception, an interrupt or a write to its own page) */
+    FISC_AOT_EXIT_HALT,  /* Reached a BL 0. The PC points to it and it was not executed                             */
+    FISC_AOT_EXIT_ERROR  /* An instruction failed. The PC points to it                                              */
+};
+
+/* The callbacks the VM hands to the translated code. 'cpu' is opaque to the library */
+typedef struct fisc_aot_api {
+    uint32_t abiVersion;
+    void     (*advance)(void * cpu, uint32_t instructions);        /* PC += instructions * 4                                   */
+    uint32_t (*step)(void * cpu, uint32_t * instructionsExecuted); /* Interpret the instruction at the PC (enum FISC_AOT_EXIT) */
+} fisc_aot_api_t;
+
+/* Where the general purpose registers of the current mode live: (*registers)[index] points to
+   register 'index' (XZR points to a zero that must never be written). The row changes along with
+   the mode, so it has to be looked up again after every step() */
+typedef uint64_t ** const * fisc_aot_registers_t;
+
+/* The translated code of one block. Returns an enum FISC_AOT_EXIT (never FISC_AOT_CONTINUE) */
+typedef uint32_t (*fisc_aot_block_fn_t)(void * cpu, const fisc_aot_api_t * api, fisc_aot_registers_t registers, uint32_t * instructionsExecuted);
+
+typedef struct {
+    uint32_t            address; /* The guest physical address of the first instruction of the block */
+    uint32_t            length;  /* How many instructions the block has                               */
+    fisc_aot_block_fn_t code;
+} fisc_aot_block_t;
+
+#ifdef FISC_AOT_LIBRARY
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Defined by the translated library (the blocks are sorted by address). The VM looks them up by name */
+extern FISC_AOT_EXPORT const uint32_t         fisc_aot_abi_version;
+extern FISC_AOT_EXPORT const uint64_t         fisc_aot_program_hash;
+extern FISC_AOT_EXPORT const uint32_t         fisc_aot_block_count;
+extern FISC_AOT_EXPORT const fisc_aot_block_t fisc_aot_blocks[];
+
+#ifdef __cplusplus
+}
+#endif
+#endif
+
+#endif
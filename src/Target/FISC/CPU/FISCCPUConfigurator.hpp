@@ -25,7 +25,7 @@
 #pragma once
 #include <fvm/Pass.h>
 #include "ISA/FISCISA.h"
-#include <map>
+#include <vector>
 
 namespace FISC {
 
@@ -44,12 +44,13 @@ private:
     /* List of permissions for external Passes that want to use the resources of this Pass */
     #define WHITELIST_CPU_CONF {DECL_WHITELIST_ALL(CPUModule)}
 public:
-    std::map<uint16_t, Instruction*> instruction_list;
+    std::vector<Instruction*> instruction_list;       /* Every instruction supported by the CPU             */
+    Instruction * opcode_table[FISC_OPCODE_TABLE_SZ]; /* The same instructions, indexed by OPCODE_MASK(...) */
 
     /***********************/
     /* Register Definition */
     /***********************/
-    uint64_t x[FISC_REGISTER_COUNT][5]; /* General purpose 64-bit registers (banked)      */
+    uint64_t x[FISC_CPU_MODE__COUNT][FISC_REGISTER_COUNT]; /* General purpose 64-bit registers (x[bank][register]. Each bank is contiguous) */
     uint32_t pc;      /* Program Counter                                                  */
     uint32_t esr;     /* Exception Syndrome Register                                      */
     uint64_t elr;     /* Exception Link / Return Register                                 */
@@ -81,9 +82,13 @@ public:
                     break;
                 }
                 instruction_list_realloc[i]->targetName = getTarget()->targetName;
-                instruction_list[instruction_list_realloc[i]->opcodeShifted] = instruction_list_realloc[i];
+                instruction_list_realloc[i]->id = (uint8_t)instruction_list.size();
+                instruction_list.push_back(instruction_list_realloc[i]);
             }
 
+            if (success == PASS_RET_OK && !buildOpcodeTable())
+                success = PASS_RET_ERR;
+
             if (success == PASS_RET_OK) {
                 DEBUG(DINFO, "CPU supports %d unique instructions", instruction_list_size);
 
@@ -125,6 +130,57 @@ public:
         return success;
     }
 
+    bool buildOpcodeTable()
+    {
+        /* Expand every opcode into all of its don't care slots, so that the
+           decoder can find any instruction with a single table lookup */
+        Instruction * branchInstruction = nullptr;
+
+        if (instruction_list.size() > FISC_MAX_INSTRUCTIONS) {
+            DEBUG(DERROR, "FATAL ERROR: The CPU declares %d instructions but only %d are supported", (int)instruction_list.size(), FISC_MAX_INSTRUCTIONS);
+            return false;
+        }
+
+        for (unsigned int slot = 0; slot < FISC_OPCODE_TABLE_SZ; slot++)
+            opcode_table[slot] = nullptr;
+
+        for (auto & instr : instruction_list) {
+            if (!instr->initialized)
+                continue;
+
+            unsigned int dontCareBits = FISC_OPCODE_SZ - instr->opcodeSize;
+            unsigned int firstSlot = (unsigned int)instr->opcodeShifted << dontCareBits;
+            unsigned int lastSlot = firstSlot + (1 << dontCareBits);
+
+            for (unsigned int slot = firstSlot; slot < lastSlot && slot < FISC_OPCODE_TABLE_SZ; slot++) {
+                Instruction * other = opcode_table[slot];
+
+                if (other == nullptr || other->opcodeSize < instr->opcodeSize) {
+                    /* The widest opcode always wins (the decoder used to try the widths from 11 down to 6 bits) */
+                    opcode_table[slot] = instr;
+                }
+                else if (other->opcodeSize == instr->opcodeSize) {
+                    /* Oh no, there is a conflict between instructions */
+                    DEBUG(DERROR, "FATAL ERROR: The instruction %s (opcode 0x%X) is in conflict with instruction %s (opcode 0x%X)",
+                        instr->opcodeStr.c_str(), instr->opcode,
+                        other->opcodeStr.c_str(), other->opcode);
+                    return false;
+                }
+            }
+
+            if (instr->opcode == B && instr->format == IFMT_B)
+                branchInstruction = instr;
+        }
+
+        /* FIXME: The B instruction is also decoded from the opcodes where (opcode & 0b11111100000) >> 1 == B.
+           This used to be a hardcoded special case inside the decoder and it takes priority over everything else */
+        if (branchInstruction != nullptr)
+            for (unsigned int slot = (B << 1); slot < (B << 1) + (1 << (FISC_OPCODE_SZ - 6)); slot++)
+                opcode_table[slot] = branchInstruction;
+
+        return true;
+    }
+
     enum PassRetcode finit()
     {
         return PASS_RET_OK;
@@ -0,0 +1,76 @@
+#ifndef FISCCPUDECODECACHE_H_
+#define FISCCPUDECODECACHE_H_
+
+#include "ISA/FISCISA.h"
+#include <vector>
+#include <memory>
+
+namespace FISC {
+
+/***************************************/
+/* Predecoded instruction cache layout */
+/***************************************/
+
+#define FISC_DECODE_CACHE_SLOTS (FISC_PAGE_SIZE / (FISC_INSTRUCTION_SZ / 8)) /* How many instructions fit inside one guest page */
+
+/* Macro-op fusion: idioms the threaded engine runs as a single operation (see CPUModule::fuseBlock()) */
+enum FISC_FUSION_KIND {
+    FISC_FUSION_NONE,
+    FISC_FUSION_MOVWIDE,    /* MOVZ followed by MOVKs on the same register: one 64 bit constant load */
+    FISC_FUSION_CMPBRANCH   /* SUBS / SUBIS / ANDS / ANDIS into XZR followed by BCOND: compare and branch */
+};
+
+#define FISC_FUSION_MAX_LENGTH 4 /* The longest group (MOVZ + 3 MOVKs) */
+
+typedef struct {
+    decoded_op_t op;          /* The decoded instruction (the slot is empty if op.handler is nullptr) */
+    uint32_t     instruction; /* The raw instruction word that was fetched from memory                */
+    uint8_t      fusion;      /* The group (enum FISC_FUSION_KIND) this instruction is the first of   */
+    uint8_t      fusedLength; /* How many instructions the group has                                  */
+    uint64_t     fusedValue;  /* MOVWIDE: the constant. CMPBRANCH: the branch displacement            */
+} decode_cache_entry_t;
+
+/****************/
+/* Basic blocks */
+/****************/
+
+#define FISC_BLOCK_EXIT_TAKEN       0 /* The block ended with a taken branch (or an exception)    */
+#define FISC_BLOCK_EXIT_FALLTHROUGH 1 /* The block ended by falling through to the next address */
+#define FISC_BLOCK_EXITS            2
+
+#define FISC_IBTC_SIZE 64 /* How many entries the indirect branch target cache (BR / BRL) has */
+
+struct decode_block;
+
+/* A link from the exit of a block straight to its successor */
+typedef struct {
+    uint32_t              targetPC; /* The guest address the link was made for                                */
+    uint32_t              epoch;    /* The decode cache epoch when the link was made (stale if it has changed) */
+    struct decode_block * target;   /* The successor block                                                    */
+} decode_block_link_t;
+
+/* A run of straight line instructions, ending on the first control flow instruction
+   (or on the end of the page). The entries of the block live on its decode cache page */
+typedef struct decode_block {
+    decode_cache_entry_t * first;      /* The first instruction of the block                          */
+    uint32_t               address;    /* The guest physical address of the first instruction         */
+    uint32_t               page;       /* The guest physical page that holds the block                */
+    uint16_t               length;     /* How many instructions the block has                         */
+    bool                   indirect;   /* The block ends with BR / BRL (its successors use the IBTC)  */
+    decode_block_link_t    chain[FISC_BLOCK_EXITS];
+    uint32_t               hotness;    /* How many times the block was entered (until it's translated) */
+    void                 * native;     /* The translated code of the block (a jit_block_fn_t), if any  */
+    void                 * aot;        /* The ahead-of-time translated code of the block (a fisc_aot_block_fn_t), if any */
+} decode_block_t;
+
+/* All the predecoded instructions (and the blocks starting on them) of a single 4 KiB guest physical page */
+typedef struct {
+    decode_cache_entry_t entries[FISC_DECODE_CACHE_SLOTS];
+    std::unique_ptr<decode_block_t> blocks[FISC_DECODE_CACHE_SLOTS];
+} decode_cache_page_t;
+
+typedef std::vector<std::unique_ptr<decode_cache_page_t> > decode_cache_t;
+
+}
+
+#endif
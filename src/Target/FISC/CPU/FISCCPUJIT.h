@@ -0,0 +1,252 @@
+#ifndef FISCCPUJIT_H_
+#define FISCCPUJIT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace FISC {
+
+/*******************************************/
+/* Dynamic binary translator (x86-64 host) */
+/*******************************************/
+
+/* The translator only knows how to emit x86-64 code */
+#if defined(__x86_64__) || defined(_M_X64)
+#define FISC_HAS_JIT 1
+#else
+#define FISC_HAS_JIT 0
+#endif
+
+#define FISC_JIT_BUFFER_SIZE       (16 * 1024 * 1024) /* How large the executable code buffer is (in bytes)                 */
+#define FISC_JIT_DEFAULT_THRESHOLD 32                 /* How many times a block has to run before it gets translated        */
+
+/* Why the translated code of a block returned to the dispatcher */
+enum FISC_JIT_EXIT {
+    JIT_EXIT_BLOCK, /* The block is over (it ran to its end or hit a branch, an exception, an interrupt or a store) */
+    JIT_EXIT_HALT,  /* Reached a BL 0. The PC points to it and it was not executed                                */
+    JIT_EXIT_ERROR  /* An instruction failed. The PC points to it                                                 */
+};
+
+class CPUModule;
+
+/* The translated code of one block */
+typedef uint32_t (*jit_block_fn_t)(CPUModule * cpu, uint32_t * instructionsExecuted);
+
+/* The x86-64 registers the translator uses */
+enum X64_REG {
+    X64_RAX = 0, X64_RCX = 1, X64_RDX = 2, X64_RBX = 3,
+    X64_RSP = 4, X64_RBP = 5, X64_RSI = 6, X64_RDI = 7,
+    X64_R11 = 11, X64_R14 = 14
+};
+
+#ifdef _WIN32
+#define X64_ARG0 X64_RCX /* Microsoft x64 calling convention */
+#define X64_ARG1 X64_RDX
+#else
+#define X64_ARG0 X64_RDI /* System V AMD64 calling convention */
+#define X64_ARG1 X64_RSI
+#endif
+
+/* An executable buffer that code is emitted into, one block at a time.
+   Nothing is ever freed individually: once the buffer fills up, the whole
+   buffer is reset (along with every block that was translated into it).
+   The buffer is never writable and executable at the same time: the pages
+   being emitted into are RW until commit() turns them back to RX */
+class JITCodeBuffer {
+public:
+    JITCodeBuffer() : base(nullptr), size(0), used(0), cursor(0), pageSize(0), overflow(false) { }
+
+    ~JITCodeBuffer()
+    {
+        release();
+    }
+
+    bool allocate(size_t bytes)
+    {
+        release();
+#ifdef _WIN32
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        pageSize = info.dwPageSize;
+        base = (uint8_t*)VirtualAlloc(nullptr, bytes, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
+#else
+        pageSize = (size_t)sysconf(_SC_PAGESIZE);
+        void * mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        base = mem == MAP_FAILED ? nullptr : (uint8_t*)mem;
+#endif
+        size = base ? bytes : 0;
+        used = cursor = 0;
+        return base != nullptr;
+    }
+
+    void release()
+    {
+        if (base == nullptr)
+            return;
+#ifdef _WIN32
+        VirtualFree(base, 0, MEM_RELEASE);
+#else
+        munmap(base, size);
+#endif
+        base = nullptr;
+        size = used = cursor = 0;
+    }
+
+    void reset()
+    {
+        used = cursor = 0;
+    }
+
+    bool isAllocated()
+    {
+        return base != nullptr;
+    }
+
+    /* Emission of a block: begin(), emit..., then commit() (which fails if the buffer overflowed).
+       If the protection of the pages cannot be changed, the buffer is released (so isAllocated()
+       tells the caller that translating is over) */
+    void * begin()
+    {
+        cursor = used;
+        overflow = !protect(used, false);
+        return base + used;
+    }
+
+    bool commit()
+    {
+        size_t start = used;
+        if (!overflow)
+            used = cursor;
+        if (!protect(start, true))
+            return false;
+        if (overflow)
+            return false;
+#ifdef _WIN32
+        FlushInstructionCache(GetCurrentProcess(), base + start, used - start);
+#else
+        __builtin___clear_cache((char*)base + start, (char*)base + used);
+#endif
+        return true;
+    }
+
+    /* Makes everything from the page holding 'from' to the end of the buffer RW (or RX) */
+    bool protect(size_t from, bool executable)
+    {
+        if (base == nullptr)
+            return false;
+        size_t first = from - from % pageSize;
+        if (first >= size)
+            return true;
+#ifdef _WIN32
+        DWORD old;
+        bool ok = VirtualProtect(base + first, size - first, executable ? PAGE_EXECUTE_READ : PAGE_READWRITE, &old) != 0;
+#else
+        bool ok = mprotect(base + first, size - first, executable ? PROT_READ | PROT_EXEC : PROT_READ | PROT_WRITE) == 0;
+#endif
+        if (!ok)
+            release();
+        return ok;
+    }
+
+    size_t position()
+    {
+        return cursor;
+    }
+
+    void emit8(uint8_t byte)
+    {
+        if (cursor < size)
+            base[cursor++] = byte;
+        else
+            overflow = true;
+    }
+
+    void emit32(uint32_t val)
+    {
+        for (unsigned i = 0; i < 4; i++)
+            emit8((uint8_t)(val >> (i * 8)));
+    }
+
+    void emit64(uint64_t val)
+    {
+        for (unsigned i = 0; i < 8; i++)
+            emit8((uint8_t)(val >> (i * 8)));
+    }
+
+    /* Point the rel32 that was emitted at 'at' to the current position */
+    void bindRel32(size_t at)
+    {
+        if (overflow || at + 4 > size)
+            return;
+        uint32_t rel = (uint32_t)(cursor - (at + 4));
+        for (unsigned i = 0; i < 4; i++)
+            base[at + i] = (uint8_t)(rel >> (i * 8));
+    }
+
+    /***********************/
+    /* x86-64 instructions */
+    /***********************/
+    void push(enum X64_REG reg)             { if (reg >= 8) emit8(0x41); emit8(0x50 + (reg & 7)); }
+    void pop(enum X64_REG reg)              { if (reg >= 8) emit8(0x41); emit8(0x58 + (reg & 7)); }
+    void ret()                              { emit8(0xC3); }
+    void subRsp(uint8_t imm)                { emit8(0x48); emit8(0x83); emit8(0xEC); emit8(imm); }
+    void addRsp(uint8_t imm)                { emit8(0x48); emit8(0x83); emit8(0xC4); emit8(imm); }
+    void movEaxImm(uint32_t imm)            { emit8(0xB8); emit32(imm); }
+    void cmpEaxImm(uint8_t imm)             { emit8(0x83); emit8(0xF8); emit8(imm); }
+
+    /* mov reg, imm64 */
+    void movImm64(enum X64_REG reg, uint64_t imm)
+    {
+        emit8(0x48 | (reg >= 8 ? 1 : 0));
+        emit8(0xB8 + (reg & 7));
+        emit64(imm);
+    }
+
+    /* mov dst, src (64 bits) */
+    void movReg(enum X64_REG dst, enum X64_REG src)
+    {
+        emit8(0x48 | (src >= 8 ? 4 : 0) | (dst >= 8 ? 1 : 0));
+        emit8(0x89);
+        emit8(0xC0 | ((src & 7) << 3) | (dst & 7));
+    }
+
+    /* call reg */
+    void call(enum X64_REG reg)
+    {
+        if (reg >= 8) emit8(0x41);
+        emit8(0xFF);
+        emit8(0xD0 | (reg & 7));
+    }
+
+    /* The memory operands below must not be based on rsp/r12 or rbp/r13 (those need a SIB byte / displacement) */
+
+    /* add dword [reg], imm8 */
+    void addMem32Imm(enum X64_REG reg, uint8_t imm) { if (reg >= 8) emit8(0x41); emit8(0x83); emit8(reg & 7); emit8(imm); }
+    /* mov dword [reg], imm32 */
+    void movMem32Imm(enum X64_REG reg, uint32_t imm) { if (reg >= 8) emit8(0x41); emit8(0xC7); emit8(reg & 7); emit32(imm); }
+    /* cmp byte [reg], imm8 */
+    void cmpMem8Imm(enum X64_REG reg, uint8_t imm) { if (reg >= 8) emit8(0x41); emit8(0x80); emit8(0x38 | (reg & 7)); emit8(imm); }
+
+    /* Jumps with a rel32 to be bound later. They return where the rel32 is */
+    size_t jmp() { emit8(0xE9); size_t at = cursor; emit32(0); return at; }
+    size_t je()  { emit8(0x0F); emit8(0x84); size_t at = cursor; emit32(0); return at; }
+    size_t jne() { emit8(0x0F); emit8(0x85); size_t at = cursor; emit32(0); return at; }
+
+private:
+    uint8_t * base;
+    size_t size;
+    size_t used;     /* Bytes taken by the blocks committed so far */
+    size_t cursor;   /* Where the next byte goes                   */
+    size_t pageSize; /* Granularity of the protection changes      */
+    bool overflow;
+};
+
+}
+
+#endif
@@ -2,6 +2,13 @@
 #define FISCCPUMODULE_H_
 
 #include <fvm/Pass.h>
+#include <atomic>
+#include <memory>
+#include "FISCCPUDecodeCache.h"
+#include "FISCCPUJIT.h"
+#include "FISCCPUTranslationCache.h"
+#include "FISCCPUAOT.h"
+#include "FISCCPUTLB.h"
 
 namespace FISC {
 
@@ -10,11 +17,79 @@ class MemoryModule;
 class CPUConfigurator;
 class Instruction;
 
+/* The execution engines the CPU can run with */
+enum FISC_CPU_ENGINE {
+    FISC_ENGINE_REFERENCE, /* Fetch, decode and execute one instruction per loop iteration                */
+    FISC_ENGINE_THREADED,  /* Threaded: jumps from one decoded instruction's label to the next one's     */
+    FISC_ENGINE_JIT        /* The threaded engine, plus x86-64 translation of the hot blocks             */
+};
+
+/* The labels of the threaded engine. The hottest instructions get their own label with their
+   body inlined on it. Everything else shares a label that calls the instruction handler */
+enum THREADED_OP_KIND {
+    THREADED_OP_EXECUTE,     /* Run the instruction handler        */
+    THREADED_OP_BRANCH_LINK, /* BL (which might be a HALT)         */
+    THREADED_OP_FUSIBLE,     /* Might be the first of a fused group */
+    THREADED_OP_ADD,         /* Inlined: R[Rd] = R[Rn] + R[Rm]     */
+    THREADED_OP_ADDI,        /* Inlined: R[Rd] = R[Rn] + ALUImm    */
+    THREADED_OP_SUB,         /* Inlined: R[Rd] = R[Rn] - R[Rm]     */
+    THREADED_OP_SUBI,        /* Inlined: R[Rd] = R[Rn] - ALUImm    */
+    THREADED_OP_AND,         /* Inlined: R[Rd] = R[Rn] & R[Rm]     */
+    THREADED_OP_ORR,         /* Inlined: R[Rd] = R[Rn] | R[Rm]     */
+    THREADED_OP__COUNT
+};
+
+/* What each instruction can be inside a fused group (see CPUModule::fuseBlock()) */
+enum FISC_FUSION_ROLE {
+    FISC_FUSION_ROLE_NONE,
+    FISC_FUSION_ROLE_MOVZ,    /* Starts a MOVWIDE group            */
+    FISC_FUSION_ROLE_MOVK,    /* Continues a MOVWIDE group         */
+    FISC_FUSION_ROLE_COMPARE, /* SUBS / SUBIS / ANDS / ANDIS: starts a CMPBRANCH group */
+    FISC_FUSION_ROLE_BCOND    /* Ends a CMPBRANCH group            */
+};
+
+/* What the hot paths (the reference loop, the fetch and the memory accessors) get specialized on.
+   Every combination has its own instantiation, picked at launch and again whenever paging is toggled */
+enum FISC_CPU_FEATURE {
+    FISC_FEATURE_TRACE  = (1 << 0), /* Every instruction (and memory access) is printed (no -nodbgexec) */
+    FISC_FEATURE_PAGING = (1 << 1), /* Virtual memory is enabled (CPSR.PG)                              */
+    FISC_FEATURE__COMBINATIONS = 4
+};
+
+/* Returns the instantiation of a member template that matches a feature mask */
+#define FISC_FEATURE_DISPATCH(features, function, args)                                       \
+    switch (features) {                                                                       \
+    case 0:                   return function<0> args;                                        \
+    case FISC_FEATURE_TRACE:  return function<FISC_FEATURE_TRACE> args;                       \
+    case FISC_FEATURE_PAGING: return function<FISC_FEATURE_PAGING> args;                      \
+    default:                  return function<FISC_FEATURE_TRACE | FISC_FEATURE_PAGING> args; \
+    }
+
+/* Labels as values (computed goto) are a GNU extension */
+#if defined(__GNUC__) || defined(__clang__)
+#define FISC_HAS_COMPUTED_GOTO 1
+#else
+#define FISC_HAS_COMPUTED_GOTO 0
+#endif
+
 class CPUModule : public RunPass {
 private:
     /* Pass properties */
     #define CPU_MODULE_PRIORITY 3 /* The execution priority of this module */
 
+    /* Disassembler properties */
+    #define FISC_DISASSEMBLY_MAX_SZ 64 /* The largest string the disassembler will produce (including the null terminator) */
+
+    /* Execution engine properties */
+    #define CPU_FLAG_ENGINE        "engine"       /* --engine=reference|threaded|jit                       */
+    #define CPU_FLAG_JIT_THRESHOLD "jitthreshold" /* --jitthreshold=<times a block runs before translation> */
+    #define CPU_FLAG_TCACHE        "tcache"       /* --tcache=<directory where the translation caches live> */
+    #define CPU_FLAG_AOT           "aot"          /* --aot=<library made by fisc-aot for this program>     */
+
+    /* Multiprocessing properties */
+    #define CPU_FLAG_CORES       "cores" /* --cores=<how many cores the machine has (1 .. FISC_MAX_CORES)> */
+    #define FISC_CORE_STACK_SIZE 0x10000 /* How far apart the initial stack pointers of the cores are     */
+
 private:
     IOMachineConfigurator * ioconf; /* The handle for the configuration of the IO Controller          */
     MemoryModule    * memory;       /* The main memory handle                                         */
@@ -27,6 +102,52 @@ private:
     bool generatedInterrupt;
     bool generatedExternalInterrupt;
     unsigned oldCPUMode;
+    decode_cache_t decodeCache; /* Predecoded instructions, indexed by guest physical page       */
+    uint32_t ioFirstPage;       /* The first page of the IO address space (never cached)         */
+    uint32_t ioLastPage;        /* The last page of the IO address space (never cached)          */
+    decoded_op_t uncachedOp;    /* Holds the decoded instruction when the fetch bypassed the cache */
+    enum FISC_CPU_ENGINE engine; /* The engine that runs the instructions                        */
+    uint8_t threadedOpKinds[FISC_MAX_INSTRUCTIONS]; /* The threaded engine label of each instruction (enum THREADED_OP_KIND) */
+    bool endsBlock[FISC_MAX_INSTRUCTIONS];          /* Which instructions end a basic block                                  */
+    uint8_t fusionRoles[FISC_MAX_INSTRUCTIONS];     /* What each instruction can be in a fused group (enum FISC_FUSION_ROLE) */
+    uint32_t timesExecuted[FISC_MAX_INSTRUCTIONS];  /* How many times this core ran each instruction (per core: no shared cache lines) */
+    std::string returnMessage;                      /* What the last instruction that used RETURN() had to say                */
+    uint32_t decodeCacheEpoch;                      /* Bumped whenever decoded pages (and their blocks) are thrown away      */
+    decode_block_link_t ibtc[FISC_IBTC_SIZE];       /* Indirect branch target cache, indexed by target address              */
+    JITCodeBuffer jitCode;                          /* The translated blocks                                                 */
+    uint32_t jitThreshold;                          /* How many times a block runs before it gets translated                */
+    std::string tcacheDir;                          /* Where the translation cache is kept (empty if disabled)              */
+    void * aotLibrary;                              /* The ahead-of-time translated program (nullptr if none was loaded)    */
+    const fisc_aot_block_t * aotBlocks;             /* Its blocks, sorted by address                                         */
+    uint32_t aotBlockCount;
+    fisc_aot_api_t aotAPI;                          /* What the translated code calls back into                              */
+    std::vector<bool> aotStalePages;                /* The pages that were written to (their translated code is out of date) */
+    tlb_entry_t tlb[FISC_TLB_SIDES][FISC_TLB_ENTRIES]; /* Cached page walks (only used while paging is enabled)              */
+    std::vector<bool> tlbTableFrames;               /* The physical pages the cached walks read their entries from          */
+    std::vector<uint32_t> tlbTableFrameList;        /* The same pages, listed (so a flush only clears those)                */
+    bool     exclusiveValid;                        /* The exclusive monitor: armed by LDXR, consumed by STXR                */
+    uint32_t exclusiveAddress;                      /* The physical address LDXR loaded from                                 */
+    uint64_t exclusiveValue;                        /* And the value it read there                                           */
+    enum FISC_DATATYPE exclusiveDataType;
+    unsigned coreID;                                /* Which core this is (0 is the boot core, the one registered as a pass) */
+    CPUModule * bootCore;                           /* The core that owns (and starts) all the other ones                    */
+    std::vector<CPUModule*> cores;                  /* Every core of the machine, indexed by core ID (boot core only)        */
+    std::vector<std::unique_ptr<CPUConfigurator> > secondaryConfs; /* The register files of the other cores (boot core only) */
+    std::vector<std::unique_ptr<CPUModule> > secondaryCores;        /* And the cores themselves                              */
+    std::vector<std::unique_ptr<thread> > secondaryThreads;         /* Where they run                                        */
+    std::atomic<uint64_t> pendingIRQs;              /* One bit per interrupt code that a device (or another core) raised    */
+    bool coreSucceeded;                             /* How a secondary core's execution ended                                */
+    uint32_t coreInstructionsExecuted;
+    bool     flagsPending;                          /* The NZCV bits of the CPSR are stale: the last flag setting instruction */
+    uint64_t flagsResult;                           /* only left its result, operands and operation here, and the flags get   */
+    uint64_t flagsOperand1;                         /* worked out of them when something reads them                           */
+    uint64_t flagsOperand2;
+    char     flagsOperation;
+    uint64_t * registerBanks[FISC_CPU_MODE__COUNT][FISC_REGISTER_COUNT]; /* Per mode: where each register index really lives */
+    uint64_t ** registerBank;                       /* The row of registerBanks of the current mode                          */
+    uint64_t zeroRegister;                          /* What XZR points to                                                    */
+    unsigned features;                              /* The FISC_CPU_FEATURE mask the running instantiations were picked for  */
+    bool     featuresChanged;                       /* The mask changed: the reference loop has to switch instantiations     */
 
 public:
     uint64_t readRegister(unsigned registerIndex);
@@ -44,13 +165,35 @@ public:
     enum FISC_RETTYPE mmu_write(uint64_t data, uint32_t address, 
                                 enum FISC_DATATYPE dataType, bool forceAlign,
                                 bool isLittleEndian, bool debug);
+    uint64_t mmu_read_exclusive(uint32_t address, enum FISC_DATATYPE dataType,
+                                bool isLittleEndian, bool debug);
+    enum FISC_RETTYPE mmu_write_exclusive(uint64_t data, uint32_t address,
+                                          enum FISC_DATATYPE dataType,
+                                          bool isLittleEndian, bool debug);
+    enum FISC_RETTYPE mmu_atomic(enum FISC_ATOMIC_OP op, uint32_t address,
+                                 enum FISC_DATATYPE dataType, uint64_t operand,
+                                 uint64_t & oldValue, bool isLittleEndian, bool debug);
 
     enum FISC_RETTYPE triggerSoftInterrupt(unsigned intCode);
-    enum FISC_RETTYPE triggerHardInterrupt(unsigned intCode);
+    enum FISC_RETTYPE triggerHardInterrupt(unsigned intCode); /* Only from the thread running this core. Devices use raiseInterrupt() */
     enum FISC_RETTYPE triggerSoftException(unsigned excCode);
     enum FISC_RETTYPE triggerHardException(unsigned excCode);
     enum FISC_RETTYPE intExcReturn(uint32_t retAddr);
 
+    Instruction * getInstructionInfo(const decoded_op_t * op);
+
+    bool flagN();
+    bool flagZ();
+    bool flagC();
+    bool flagV();
+    bool conditionHolds(unsigned cond);
+    void setReturnMessage(const std::string & message);
+    unsigned getAlignmentEnable(); /* CPSR.AE, without working out the pending flags */
+
+    unsigned getCoreID();
+    bool raiseInterrupt(unsigned intCode);
+    bool sendInterProcessorInterrupt(unsigned targetCore, unsigned intCode);
+
 private:
     enum FISC_RETTYPE enterISR(uint32_t interruptVectorPtr, unsigned isrID);
     enum FISC_RETTYPE enterEXC(uint32_t exceptionVectorPtr, unsigned excID);
@@ -65,14 +208,48 @@ private:
     enum FISC_RETTYPE interruptCPU(unsigned code, bool isException, bool isInternal);
     bool detectOverflow(uint64_t operand1, uint64_t operand2, char operation);
     bool detectCarry(uint64_t operand1, uint64_t operand2, char operation);
-    Instruction * decode(uint32_t instruction);
-    std::string disassembleConstant(unsigned val);
-    std::string disassembleRegister(unsigned registerIndex);
-    std::string disassembleBCC(unsigned cc);
-    std::string disassemble(Instruction * instruction);
+    void materializeFlags();
+    void buildRegisterBanks();
+    void selectRegisterBank();
+    void updateFeatures();
+    template<unsigned Features> uint64_t mmu_readAs(uint32_t address, enum FISC_DATATYPE dataType, bool forceAlign, bool isLittleEndian, bool debug);
+    template<unsigned Features> enum FISC_RETTYPE mmu_writeAs(uint64_t data, uint32_t address, enum FISC_DATATYPE dataType, bool forceAlign, bool isLittleEndian, bool debug);
+    template<unsigned Features> const decoded_op_t * fetchAs(uint32_t virtualAddr, uint32_t & instruction);
+    bool decode(uint32_t instruction, decoded_op_t & op);
+    const decoded_op_t * fetch(uint32_t virtualAddr, uint32_t & instruction);
+    void invalidateDecodePage(uint32_t page);
+    void flushDecodeCache();
+    decode_block_t * lookupBlock(uint32_t virtualAddr);
+    void fuseBlock(decode_block_t * block);
+    enum FISC_RETTYPE executeFused(const decode_cache_entry_t * entry, uint32_t pc);
+    bool jitCompileBlock(decode_block_t * block);
+    bool isStoreOpcode(enum OPCODE opcode);
+    std::string getTranslationCachePath();
+    void loadTranslationCache();
+    void saveTranslationCache();
+    bool loadAOTLibrary(const std::string & path);
+    void unloadAOTLibrary();
+    void * findAOTBlock(uint32_t physicalAddr);
+    uint32_t aotStep(uint32_t * instructionsExecuted);
+    const char * disassembleRegister(unsigned registerIndex);
+    size_t disassemble(const decoded_op_t * op, char * buffer, size_t bufferSize);
     std::string getCurrentCPUModeStr();
     enum FISC_RETTYPE enterUndefMode();
-    enum FISC_RETTYPE mmu_translate(uint32_t & retVal, uint32_t virtualAddr, bool isLittleEndian);
+    enum FISC_RETTYPE mmu_translate(uint32_t & retVal, uint32_t virtualAddr, bool isLittleEndian, enum FISC_TLB_SIDE side, bool isWrite);
+    void flushTLB();
+
+    template<unsigned Features> bool runReferenceAs(uint32_t & instructionsExecuted);
+    bool runReference(uint32_t & instructionsExecuted);
+    bool runThreaded(uint32_t & instructionsExecuted);
+    bool runCore(uint32_t & instructionsExecuted);
+
+    CPUModule(unsigned coreID, CPUModule * bootCore, CPUConfigurator * cconf);
+    enum PassRetcode initCore();
+    enum PassRetcode createSecondaryCores();
+    void startSecondaryCores();
+    void joinSecondaryCores();
+    static void secondaryCoreLauncher(void * core);
+    bool pollInterrupts();
 
     void dumpWarning(std::string problematicArg, std::string fullArg);
     void dumpInternals();
@@ -28,44 +28,68 @@
 #include "../IO/FISCIOMachineConfigurator.hpp"
 #include "FISCCPUModule.h"
 #include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
 
 namespace FISC {
 
-uint64_t CPUModule::readRegister(unsigned registerIndex)
+void CPUModule::buildRegisterBanks()
 {
-    uint8_t bank = cconf->cpsr.mode;
-
-    /* Assumptions: mode/bank is never going to hold a value different than 0 .. 5 (inclusive).
-    The CPU would have triple faulted long before then. */
-
-    if(bank == FISC_CPU_MODE_KERNEL || bank == FISC_CPU_MODE_USER || registerIndex == XZR) {
-        /* We're setting the bank to kernel for no particular reason.
-           The goal is to have both kernel and user modes to share the same bank.
-           Also, if we're reading from XZR, we don't care if the registers are banked, so
-           we set the bank value anyways for that case. */
-        bank = FISC_CPU_MODE_KERNEL;
+    /* Works out, once, which physical register each mode sees behind each register index:
+       - User and Kernel modes share the same bank
+       - IRQ / SIRQ modes only have their own X16..X30 (X0..X15 are the Kernel's)
+       - Exception / Undefined modes only have their own X28..X30 (X0..X27 are the Kernel's)
+       - XZR is the same (always zero) register on every mode */
+    for (unsigned mode = 0; mode < FISC_CPU_MODE__COUNT; mode++) {
+        for (unsigned registerIndex = 0; registerIndex < FISC_REGISTER_COUNT; registerIndex++) {
+            unsigned bank = mode;
+            if (mode == FISC_CPU_MODE_USER)
+                bank = FISC_CPU_MODE_KERNEL;
+            if ((mode == FISC_CPU_MODE_IRQ || mode == FISC_CPU_MODE_SIRQ) && registerIndex <= 15)
+                bank = FISC_CPU_MODE_KERNEL;
+            if ((mode == FISC_CPU_MODE_EXCEPTION || mode == FISC_CPU_MODE_UNDEFINED) && registerIndex <= 27)
+                bank = FISC_CPU_MODE_KERNEL;
+
+            registerBanks[mode][registerIndex] = registerIndex == XZR ? &zeroRegister : &cconf->x[bank][registerIndex];
+        }
     }
+    zeroRegister = 0;
+    selectRegisterBank();
+}
 
-    /* Special case: if we're in IRQ/SIRQ mode, the registers X0..X15 are not banked. Because of this, we'll force the bank number to be the same of the User/Kernel */
-    if((bank == FISC_CPU_MODE_IRQ || bank == FISC_CPU_MODE_SIRQ) && registerIndex >= 0 && registerIndex <= 15)
-        bank = FISC_CPU_MODE_KERNEL;
-
-    /* Special case: if we're in Exception/Undefined mode, the registers X0..X27 are not banked. Because of this, we'll force the bank number to be the same of the User/Kernel */
-    if ((bank == FISC_CPU_MODE_EXCEPTION || bank == FISC_CPU_MODE_UNDEFINED) && registerIndex >= 0 && registerIndex <= 27)
-        bank = FISC_CPU_MODE_KERNEL;
+void CPUModule::selectRegisterBank()
+{
+    /* Called whenever the CPU mode changes. An invalid mode gets the Undefined mode's bank */
+    registerBank = registerBanks[cconf->cpsr.mode < FISC_CPU_MODE__COUNT ? cconf->cpsr.mode : FISC_CPU_MODE_UNDEFINED];
+}
 
-    if(registerIndex < FISC_REGISTER_COUNT) {
-        if(registerIndex == XZR)
-            return 0;
-        else
-            return cconf->x[bank][registerIndex];
+void CPUModule::updateFeatures()
+{
+    /* Called whenever the CPSR might have toggled paging */
+    unsigned newFeatures = (memory->showExecution ? FISC_FEATURE_TRACE : 0) | (cconf->cpsr.pg ? FISC_FEATURE_PAGING : 0);
+    if (newFeatures != features) {
+        features = newFeatures;
+        featuresChanged = true;
     }
+}
+
+uint64_t CPUModule::readRegister(unsigned registerIndex)
+{
+    if(registerIndex < FISC_REGISTER_COUNT)
+        return *registerBank[registerIndex];
     else {
         switch (registerIndex) {
             case SPECIAL_PC:    return cconf->pc;
             case SPECIAL_ESR:   return cconf->esr;
             case SPECIAL_ELR:   return cconf->elr;
-            case SPECIAL_CPSR:  return *((uint64_t*)&cconf->cpsr);
+            case SPECIAL_CPSR:  materializeFlags(); return *((uint64_t*)&cconf->cpsr);
             case SPECIAL_SPSR0: return *((uint64_t*)&cconf->spsr[0]);
             case SPECIAL_SPSR1: return *((uint64_t*)&cconf->spsr[1]);
             case SPECIAL_SPSR2: return *((uint64_t*)&cconf->spsr[2]);
@@ -76,6 +100,7 @@ uint64_t CPUModule::readRegister(unsigned registerIndex)
             case SPECIAL_EVP:   return cconf->evp;
             case SPECIAL_PDP:   return cconf->pdp;
             case SPECIAL_PFLA:  return cconf->pfla;
+            case SPECIAL_CID:   return coreID;
             default:            return (uint64_t)-1;
         }
     }
@@ -87,37 +112,29 @@ enum FISC_RETTYPE CPUModule::writeRegister(unsigned registerIndex,
                                            uint64_t operand1, uint64_t operand2,
                                            char operation)
 {
-    uint8_t bank = cconf->cpsr.mode;
-
-    /* Assumptions: mode/bank is never going to hold a value different than 0 .. 5 (inclusive).
-    The CPU would have triple faulted long before then. */
-
-    if (bank == FISC_CPU_MODE_KERNEL || bank == FISC_CPU_MODE_USER || registerIndex == XZR) {
-        /* We're setting the bank to kernel for no particular reason. 
-           The goal is to have both kernel and user modes to share the same bank.
-           Also, if we're writing to XZR, we don't care if the registers are banked, so
-           we set the bank value anyways for that case. */
-        bank = FISC_CPU_MODE_KERNEL;
-    }
-
-    /* Special case: if we're in IRQ/SIRQ mode, the registers X0..X15 are not banked. Because of this, we'll force the bank number to be the same of the User/Kernel */
-    if ((bank == FISC_CPU_MODE_IRQ || bank == FISC_CPU_MODE_SIRQ) && registerIndex >= 0 && registerIndex <= 15)
-        bank = FISC_CPU_MODE_KERNEL;
-
-    /* Special case: if we're in Exception/Undefined mode, the registers X0..X27 are not banked. Because of this, we'll force the bank number to be the same of the User/Kernel */
-    if ((bank == FISC_CPU_MODE_EXCEPTION || bank == FISC_CPU_MODE_UNDEFINED) && registerIndex >= 0 && registerIndex <= 27)
-        bank = FISC_CPU_MODE_KERNEL;
-
     if (registerIndex < FISC_REGISTER_COUNT) {
         if(registerIndex != XZR)
-            cconf->x[bank][registerIndex] = data;
+            *registerBank[registerIndex] = data;
     }
     else {
         switch (registerIndex) {
             case SPECIAL_PC:    cconf->pc      = (uint32_t)data;  break;
             case SPECIAL_ESR:   cconf->esr     = (uint32_t)data;  break;
             case SPECIAL_ELR:   cconf->elr     = data;            break;
-            case SPECIAL_CPSR:  cconf->cpsr    = *(cpsr_t*)&data; break;
+            case SPECIAL_CPSR: {
+                cpsr_t oldCPSR = cconf->cpsr;
+                cconf->cpsr = *(cpsr_t*)&data;
+                flagsPending = false; /* The flags that were written win over the pending ones */
+                if (oldCPSR.mode != cconf->cpsr.mode)
+                    selectRegisterBank();
+                /* The cached translations were made for the old paging state. A mode change
+                   alone keeps them: a TLB hit checks the user permission against the current mode */
+                if (oldCPSR.pg != cconf->cpsr.pg) {
+                    flushTLB();
+                    updateFeatures();
+                }
+                break;
+            }
             case SPECIAL_SPSR0: cconf->spsr[0] = *(cpsr_t*)&data; break;
             case SPECIAL_SPSR1: cconf->spsr[1] = *(cpsr_t*)&data; break;
             case SPECIAL_SPSR2: cconf->spsr[2] = *(cpsr_t*)&data; break;
@@ -126,17 +143,20 @@ enum FISC_RETTYPE CPUModule::writeRegister(unsigned registerIndex,
             case SPECIAL_SPSR5: cconf->spsr[5] = *(cpsr_t*)&data; break;
             case SPECIAL_IVP:   cconf->ivp     = data;            break;
             case SPECIAL_EVP:   cconf->evp     = data;            break;
-            case SPECIAL_PDP:   cconf->pdp     = data;            break;
+            case SPECIAL_PDP:   cconf->pdp     = data; flushTLB(); break;
             case SPECIAL_PFLA:  cconf->pfla    = data;            break;
+            case SPECIAL_CID:   /* Read only */ return FISC_RET_ERROR;
             default: return FISC_RET_ERROR;
         }
     }
 
     if(setFlags) {
-        cconf->cpsr.n = (((int64_t)data) < 0) ? 1 : 0;
-        cconf->cpsr.z = data == 0 ? 1 : 0;
-        cconf->cpsr.v = detectOverflow(operand1, operand2, operation) ? 1 : 0;
-        cconf->cpsr.c = detectCarry(operand1, operand2, operation) ? 1 : 0;
+        /* The flags are only worked out if (and when) something reads them */
+        flagsPending = true;
+        flagsResult = data;
+        flagsOperand1 = operand1;
+        flagsOperand2 = operand2;
+        flagsOperation = operation;
     }
 
     return FISC_RET_OK;
@@ -156,49 +176,147 @@ enum FISC_RETTYPE CPUModule::branch(uint32_t new_addr, bool isPCRel)
     return success;
 }
 
-uint64_t CPUModule::mmu_read(uint32_t address, enum FISC_DATATYPE dataType, bool forceAlign, bool isLittleEndian, bool debug)
+template<unsigned Features>
+uint64_t CPUModule::mmu_readAs(uint32_t address, enum FISC_DATATYPE dataType, bool forceAlign, bool isLittleEndian, bool debug)
 {
-    if (cconf->cpsr.pg) {
+    if (Features & FISC_FEATURE_PAGING) {
         /* Paging is enabled. We must access the memory using the value inside register
            PDP, which contains a pointer to a page directory.
            Using this virtual address, we can access the page directory to look for the
            real physical memory address. Only then we can really access the memory module */
         uint32_t physicalAddress = (uint32_t)-1;
-        if(mmu_translate(physicalAddress, address, isLittleEndian) != FISC_RET_OK) {
+        if(mmu_translate(physicalAddress, address, isLittleEndian, FISC_TLB_DATA, false) != FISC_RET_OK) {
             /* The current cpu mode does not have access privileges over this page. 
                Calling the page fault ISR ... */
             triggerSoftException(EXC_PAGEFAULT);
             return (uint64_t)-1;
         }
 
-        return memory->read(physicalAddress, dataType, forceAlign, cconf->cpsr.pg, isLittleEndian, debug);
-    }
-    else {
-        /* Paging is disabled */
-        return memory->read(address, dataType, forceAlign, cconf->cpsr.pg, isLittleEndian, debug);
+        address = physicalAddress;
     }
+
+    const bool isMMUOn = (Features & FISC_FEATURE_PAGING) != 0;
+    if ((Features & FISC_FEATURE_TRACE) && debug)
+        return forceAlign ? memory->readAs<true, true>(address, dataType, isMMUOn, isLittleEndian, debug) : memory->readAs<true, false>(address, dataType, isMMUOn, isLittleEndian, debug);
+    return forceAlign ? memory->readAs<false, true>(address, dataType, isMMUOn, isLittleEndian, debug) : memory->readAs<false, false>(address, dataType, isMMUOn, isLittleEndian, debug);
 }
 
-enum FISC_RETTYPE CPUModule::mmu_write(uint64_t data, uint32_t address, enum FISC_DATATYPE dataType, bool forceAlign, bool isLittleEndian, bool debug)
+uint64_t CPUModule::mmu_read(uint32_t address, enum FISC_DATATYPE dataType, bool forceAlign, bool isLittleEndian, bool debug)
 {
-    if (cconf->cpsr.pg) {
+    FISC_FEATURE_DISPATCH(features, mmu_readAs, (address, dataType, forceAlign, isLittleEndian, debug));
+}
+
+template<unsigned Features>
+enum FISC_RETTYPE CPUModule::mmu_writeAs(uint64_t data, uint32_t address, enum FISC_DATATYPE dataType, bool forceAlign, bool isLittleEndian, bool debug)
+{
+    if (Features & FISC_FEATURE_PAGING) {
         /* Paging is enabled. We must access the memory using the value inside register
            PDP, which contains a pointer to a page directory.
            Using this virtual address, we can access the page directory to look for the
            real physical memory address. Only then we can really access the memory module */
         uint32_t physicalAddress = (uint32_t)-1;
-        if (mmu_translate(physicalAddress, address, isLittleEndian) != FISC_RET_OK) {
+        if (mmu_translate(physicalAddress, address, isLittleEndian, FISC_TLB_DATA, true) != FISC_RET_OK) {
             /* The current cpu mode does not have access privileges over this page.
                Calling the page fault ISR ... */
             return triggerSoftException(EXC_PAGEFAULT);
         }
 
-        return memory->write(data, physicalAddress, dataType, forceAlign, cconf->cpsr.pg, isLittleEndian, debug) ? FISC_RET_OK : FISC_RET_ERROR;
+        address = physicalAddress;
     }
-    else {
-        /* Paging is disabled */
-        return memory->write(data, address, dataType, forceAlign, cconf->cpsr.pg, isLittleEndian, debug) ? FISC_RET_OK : FISC_RET_ERROR;
+
+    /* Writing over a page table (or directory) that a TLB entry came from makes the TLB stale */
+    uint32_t firstPage = address / FISC_PAGE_SIZE;
+    uint32_t lastPage = (address + 7) / FISC_PAGE_SIZE;
+    if ((firstPage < tlbTableFrames.size() && tlbTableFrames[firstPage]) || (lastPage < tlbTableFrames.size() && tlbTableFrames[lastPage]))
+        flushTLB();
+
+    const bool isMMUOn = (Features & FISC_FEATURE_PAGING) != 0;
+    bool written;
+    if ((Features & FISC_FEATURE_TRACE) && debug)
+        written = forceAlign ? memory->writeAs<true, true>(data, address, dataType, isMMUOn, isLittleEndian, debug) : memory->writeAs<true, false>(data, address, dataType, isMMUOn, isLittleEndian, debug);
+    else
+        written = forceAlign ? memory->writeAs<false, true>(data, address, dataType, isMMUOn, isLittleEndian, debug) : memory->writeAs<false, false>(data, address, dataType, isMMUOn, isLittleEndian, debug);
+    return written ? FISC_RET_OK : FISC_RET_ERROR;
+}
+
+enum FISC_RETTYPE CPUModule::mmu_write(uint64_t data, uint32_t address, enum FISC_DATATYPE dataType, bool forceAlign, bool isLittleEndian, bool debug)
+{
+    FISC_FEATURE_DISPATCH(features, mmu_writeAs, (data, address, dataType, forceAlign, isLittleEndian, debug));
+}
+
+uint64_t CPUModule::mmu_read_exclusive(uint32_t address, enum FISC_DATATYPE dataType, bool isLittleEndian, bool debug)
+{
+    uint32_t physicalAddress = address;
+    if (cconf->cpsr.pg && mmu_translate(physicalAddress, address, isLittleEndian, FISC_TLB_DATA, false) != FISC_RET_OK) {
+        triggerSoftException(EXC_PAGEFAULT);
+        return (uint64_t)-1;
     }
+
+    uint64_t memVal = memory->read(physicalAddress, dataType, false, cconf->cpsr.pg, isLittleEndian, debug);
+
+    /* Arm the exclusive monitor with what was read */
+    exclusiveValid = true;
+    exclusiveAddress = physicalAddress;
+    exclusiveValue = memVal;
+    exclusiveDataType = dataType;
+    return memVal;
+}
+
+enum FISC_RETTYPE CPUModule::mmu_write_exclusive(uint64_t data, uint32_t address, enum FISC_DATATYPE dataType, bool isLittleEndian, bool debug)
+{
+    uint32_t physicalAddress = address;
+    if (cconf->cpsr.pg && mmu_translate(physicalAddress, address, isLittleEndian, FISC_TLB_DATA, true) != FISC_RET_OK)
+        return triggerSoftException(EXC_PAGEFAULT);
+
+    /* The host atomics behind the exclusive monitor only work on naturally aligned RAM, and the
+       guest would retry an STXR that can never succeed forever. IO (or out of range) addresses fail
+       the instruction like any invalid access does; misaligned ones raise an alignment fault */
+    if (!memory->isAddressAtomicCapable(physicalAddress, dataType)) {
+        DEBUG(DERROR, "Exclusive store to 0x%X, which is not RAM", physicalAddress);
+        return FISC_RET_ERROR;
+    }
+    if (!memory->isAddressAligned(physicalAddress, dataType))
+        return triggerSoftException(EXC_ALIGNFAULT);
+
+    /* The store only happens if the monitor is still armed for this address and the memory
+       still holds what LDXR read (someone else's store in between makes the compare fail).
+       The outcome goes into the Z flag: set on success, clear if the guest has to retry */
+    materializeFlags();
+    bool success = exclusiveValid && exclusiveAddress == physicalAddress && exclusiveDataType == dataType
+                && memory->compareExchange(physicalAddress, dataType, exclusiveValue, data, isLittleEndian, debug);
+    exclusiveValid = false;
+
+    /* Writing over a page table (or directory) that a TLB entry came from makes the TLB stale */
+    uint32_t page = physicalAddress / FISC_PAGE_SIZE;
+    if (success && page < tlbTableFrames.size() && tlbTableFrames[page])
+        flushTLB();
+
+    cconf->cpsr.z = success ? 1 : 0;
+    return FISC_RET_OK;
+}
+
+enum FISC_RETTYPE CPUModule::mmu_atomic(enum FISC_ATOMIC_OP op, uint32_t address, enum FISC_DATATYPE dataType, uint64_t operand, uint64_t & oldValue, bool isLittleEndian, bool debug)
+{
+    uint32_t physicalAddress = address;
+    if (cconf->cpsr.pg && mmu_translate(physicalAddress, address, isLittleEndian, FISC_TLB_DATA, true) != FISC_RET_OK)
+        return triggerSoftException(EXC_PAGEFAULT);
+
+    /* Same restrictions as STXR (see mmu_write_exclusive) */
+    if (!memory->isAddressAtomicCapable(physicalAddress, dataType)) {
+        DEBUG(DERROR, "Atomic access to 0x%X, which is not RAM", physicalAddress);
+        return FISC_RET_ERROR;
+    }
+    if (!memory->isAddressAligned(physicalAddress, dataType))
+        return triggerSoftException(EXC_ALIGNFAULT);
+
+    /* A failed compare (on CAS) is not an error: oldValue still tells the guest what was there */
+    if (!memory->atomicRMW(op, physicalAddress, dataType, operand, oldValue, isLittleEndian, debug))
+        return FISC_RET_ERROR;
+
+    uint32_t page = physicalAddress / FISC_PAGE_SIZE;
+    if (page < tlbTableFrames.size() && tlbTableFrames[page])
+        flushTLB();
+    return FISC_RET_OK;
 }
 
 enum FISC_RETTYPE CPUModule::triggerSoftInterrupt(unsigned intCode)
@@ -281,7 +399,11 @@ enum FISC_RETTYPE CPUModule::switchContext(enum FISC_CPU_MODE newMode)
         4- Load newMode's SPSR register into CPSR
     */
     
+    /* Entering a handler breaks any LDXR / STXR pair in flight */
+    exclusiveValid = false;
+
     /* Save first */
+    materializeFlags();
     writeRegister(SPECIAL_ELR, readRegister(SPECIAL_PC) + 4, false, 0, 0, 0); /* Save PC */
     cconf->spsr[cconf->cpsr.mode] = cconf->cpsr; /* Save current CPSR */
     oldCPUMode = cconf->cpsr.mode; /* Update the old CPU mode */
@@ -289,6 +411,8 @@ enum FISC_RETTYPE CPUModule::switchContext(enum FISC_CPU_MODE newMode)
     /* Load new mode */
     cconf->cpsr = cconf->spsr[newMode]; /* Restore the CPSR for this new mode */
     cconf->cpsr.mode = cconf->spsr[newMode].mode = newMode; /* Forcefully change the mode for both CPSR and SPSR of new mode */
+    selectRegisterBank();
+    updateFeatures();
 
     return FISC_RET_OK;
 }
@@ -302,7 +426,11 @@ enum FISC_RETTYPE CPUModule::restoreContext()
         4- Load PC from ELR
     */
 
+    /* So does returning from one */
+    exclusiveValid = false;
+
     /* Save current mode first */
+    materializeFlags();
     cconf->spsr[cconf->cpsr.mode] = cconf->cpsr;
     
     /* Toggle the oldCPUMode. We're toggling this value just so we know 
@@ -314,6 +442,8 @@ enum FISC_RETTYPE CPUModule::restoreContext()
     /* Restore old mode back */
     cconf->cpsr = cconf->spsr[oldCPUModeCopy]; /* Restore the CPSR for the old mode */
     cconf->cpsr.mode = cconf->spsr[oldCPUModeCopy].mode = oldCPUModeCopy; /* Forcefully restore the mode for both CPSR and SPSR of old mode */
+    selectRegisterBank();
+    updateFeatures();
 
     writeRegister(SPECIAL_PC, readRegister(SPECIAL_ELR), false, 0, 0, 0); /* Restore PC */
 
@@ -367,7 +497,7 @@ enum FISC_RETTYPE CPUModule::interruptCPU(unsigned code, bool isException, bool
     enum FISC_RETTYPE ret = FISC_RET_ERROR;
     uint32_t jumpAddress;
 
-    if (cconf->cpsr.mode == FISC_CPU_MODE_USER) {
+    if (cconf->cpsr.mode == FISC_CPU_MODE_USER && !isException && isInternal) {
         /* The user just tried to execute an interrupt.
            We will only give him permission if the interrupt code is exactly 0xFFF  */
         if (code != FISC_USER_SYSCALL_CODE) {
@@ -485,172 +615,426 @@ bool CPUModule::detectCarry(uint64_t operand1, uint64_t operand2, char operation
     }
 }
 
-Instruction * CPUModule::decode(uint32_t instruction)
+void CPUModule::materializeFlags()
 {
-    Instruction * result = nullptr;
+    if (!flagsPending)
+        return;
+
+    cconf->cpsr.n = (((int64_t)flagsResult) < 0) ? 1 : 0;
+    cconf->cpsr.z = flagsResult == 0 ? 1 : 0;
+    cconf->cpsr.v = detectOverflow(flagsOperand1, flagsOperand2, flagsOperation) ? 1 : 0;
+    cconf->cpsr.c = detectCarry(flagsOperand1, flagsOperand2, flagsOperation) ? 1 : 0;
+    flagsPending = false;
+}
+
+/* Each one only works out its own flag (BCOND usually needs just one or two of them) */
+bool CPUModule::flagN()
+{
+    return flagsPending ? ((int64_t)flagsResult) < 0 : cconf->cpsr.n != 0;
+}
+
+bool CPUModule::flagZ()
+{
+    return flagsPending ? flagsResult == 0 : cconf->cpsr.z != 0;
+}
+
+bool CPUModule::flagC()
+{
+    return flagsPending ? detectCarry(flagsOperand1, flagsOperand2, flagsOperation) : cconf->cpsr.c != 0;
+}
+
+bool CPUModule::flagV()
+{
+    return flagsPending ? detectOverflow(flagsOperand1, flagsOperand2, flagsOperation) : cconf->cpsr.v != 0;
+}
+
+void CPUModule::setReturnMessage(const std::string & message)
+{
+    returnMessage = message;
+}
+
+unsigned CPUModule::getAlignmentEnable()
+{
+    /* Every load and store looks at it, and most of them sit between a flag setting instruction and its BCOND */
+    return cconf->cpsr.ae;
+}
+
+bool CPUModule::conditionHolds(unsigned cond)
+{
+    /* Only the flags the condition looks at get worked out */
+    switch (cond) {
+    case BEQ: return flagZ();
+    case BNE: return !flagZ();
+    case BLT: return flagN() ^ flagV();
+    case BLE: return !(!flagZ() & !(flagN() ^ flagV()));
+    case BGT: return (!flagZ() & !(flagN() ^ flagV()));
+    case BGE: return !(flagN() ^ flagV());
+    case BLO: return !(flagC());
+    case BLS: return !(!flagZ() & flagZ());
+    case BHI: return (!flagZ() & flagC());
+    case BHS: return flagC();
+    case BMI: return flagN();
+    case BPL: return !flagN();
+    case BVS: return flagV();
+    case BVC: return !flagV();
+    default: /* Invalid condition */ return false;
+    }
+}
 
+bool CPUModule::decode(uint32_t instruction, decoded_op_t & op)
+{
     if(instruction == (uint32_t)-1)
-        return result;
+        return false;
 
     /* At this point, we don't know the width of the opcode.
-       Could be 11, 10, 9, 8 or even 6 bits wide. We must
-       decode by opcode size manually.
-    */
+       Could be 11, 10, 9, 8 or even 6 bits wide. The opcode table
+       already has every width expanded into its don't care slots,
+       so one lookup with the widest opcode is enough */
+    Instruction * result = cconf->opcode_table[OPCODE_MASK(instruction)];
 
-    /* FIXME: This manual hardcoded decoding for the B instruction is a temporary fix! */
-    if (((OPCODE_MASK(instruction) & 0b11111100000) >> 1) == B) {
-        result = cconf->instruction_list[B >> 5];
-        result->instruction = instruction;
-        result->ifmt_b = INSTR_TO_IFMT_B(result->instruction);
-        return result;
-    }
+    /* If the slot is empty, then we did not successfully
+        decode the instruction ... */
+    if(result == nullptr)
+        return false;
 
-    /* Try to decode instruction as a 11 bit opcode */
-    if((result = cconf->instruction_list[OPCODE_MASK(instruction)]) != nullptr) {
-        /* Found it! */
-        result->instruction = instruction;
-        if(result->format == IFMT_R)
-            result->ifmt_r = INSTR_TO_IFMT_R(result->instruction);
-        else if(result->format == IFMT_D)
-            result->ifmt_d = INSTR_TO_IFMT_D(result->instruction);
-        return result;
-    }
+    /* Extract the fields of the instruction word once, so that executing it never has to */
+    op.handler = result->operation;
+    op.id = result->id;
+    op.imm = 0;
+    op.rd = op.rn = op.rm = 0;
 
-    /* Try to decode instruction as a 10 bit opcode */
-    if ((result = cconf->instruction_list[OPCODE_MASK(instruction) >> 1]) != nullptr) {
-        /* Found it! */
-        result->instruction = instruction;
-        result->ifmt_i = INSTR_TO_IFMT_I(result->instruction);
-        return result;
+    switch (result->format) {
+        case IFMT_R:
+            op.rd = instrRd(instruction); op.rn = instrRn(instruction); op.rm = instrRm(instruction); op.shamt = instrShamt(instruction);
+            break;
+        case IFMT_I:
+            op.rd = instrRd(instruction); op.rn = instrRn(instruction); op.alu_immediate = instrALUImm(instruction);
+            break;
+        case IFMT_D:
+            op.rt = instrRd(instruction); op.rn = instrRn(instruction); op.op = instrDTOp(instruction); op.dt_address = instrDTAddr(instruction);
+            break;
+        case IFMT_B:
+            op.br_address = instrBrAddr(instruction);
+            break;
+        case IFMT_CB:
+            op.rt = instrRd(instruction); op.cond_br_address = instrCondBrAddr(instruction);
+            break;
+        case IFMT_IW:
+            op.rt = instrRd(instruction); op.quadrant = instrQuadrant(instruction); op.mov_immediate = instrMOVImm(instruction);
+            break;
     }
 
-    /* Try to decode instruction as a 9 bit opcode */
-    if ((result = cconf->instruction_list[OPCODE_MASK(instruction) >> 2]) != nullptr) {
-        /* Found it! */
-        result->instruction = instruction;
-        result->ifmt_iw = INSTR_TO_IFMT_IW(result->instruction);
-        return result;
+    return true;
+}
+
+template<unsigned Features>
+const decoded_op_t * CPUModule::fetchAs(uint32_t virtualAddr, uint32_t & instruction)
+{
+    /* Translate the PC first. The decode cache is indexed by physical page,
+       so that every virtual alias of the same code shares its predecoded instructions */
+    uint32_t physicalAddr = virtualAddr;
+    if ((Features & FISC_FEATURE_PAGING) && mmu_translate(physicalAddr, virtualAddr, ENDIANNESS_TEXTSECT, FISC_TLB_INSTRUCTION, false) != FISC_RET_OK) {
+        triggerSoftException(EXC_PAGEFAULT);
+        instruction = (uint32_t)-1;
+        return nullptr;
     }
 
-    /* Try to decode instruction as a 8 bit opcode */
-    if ((result = cconf->instruction_list[OPCODE_MASK(instruction) >> 3]) != nullptr) {
-        /* Found it! */
-        result->instruction = instruction;
-        result->ifmt_cb = INSTR_TO_IFMT_CB(result->instruction);
-        return result;
+    uint32_t page = physicalAddr / FISC_PAGE_SIZE;
+
+    if (page >= decodeCache.size() || (page >= ioFirstPage && page <= ioLastPage) || (physicalAddr & 3)) {
+        /* Unaligned fetches and code running from the IO address space are never cached */
+        instruction = (uint32_t)memory->readAs<false, false>(physicalAddr, FISC_SZ_32, (Features & FISC_FEATURE_PAGING) != 0, ENDIANNESS_TEXTSECT, false);
+        return decode(instruction, uncachedOp) ? &uncachedOp : nullptr;
     }
 
-    /* Try to decode instruction as a 6 bit opcode */
-    if ((result = cconf->instruction_list[OPCODE_MASK(instruction) >> 5]) != nullptr) {
-        /* Found it! */
-        result->instruction = instruction;
-        result->ifmt_b = INSTR_TO_IFMT_B(result->instruction);
-        return result;
+    /* Drop the predecoded instructions of this page if it was written to since we last saw it (self modifying code) */
+    if (memory->wasPageWritten(page, coreID))
+        invalidateDecodePage(page);
+
+    if (!decodeCache[page])
+        decodeCache[page].reset(new decode_cache_page_t());
+
+    decode_cache_entry_t & entry = decodeCache[page]->entries[(physicalAddr % FISC_PAGE_SIZE) / (FISC_INSTRUCTION_SZ / 8)];
+
+    if (entry.op.handler == nullptr) {
+        /* Cache miss: fetch and decode the instruction once */
+        instruction = (uint32_t)memory->readAs<false, false>(physicalAddr, FISC_SZ_32, (Features & FISC_FEATURE_PAGING) != 0, ENDIANNESS_TEXTSECT, false);
+        if (!decode(instruction, entry.op)) {
+            entry.op.handler = nullptr;
+            return nullptr;
+        }
+        entry.instruction = instruction;
+        return &entry.op;
     }
 
-    /* If we get to this point, then we did not successfully
-        decode the instruction ... */
-    return nullptr;	
+    /* Cache hit */
+    instruction = entry.instruction;
+    return &entry.op;
 }
 
-std::string CPUModule::disassembleConstant(unsigned val)
+const decoded_op_t * CPUModule::fetch(uint32_t virtualAddr, uint32_t & instruction)
 {
-    return std::to_string(val);
+    FISC_FEATURE_DISPATCH(features, fetchAs, (virtualAddr, instruction));
 }
 
-std::string CPUModule::disassembleRegister(unsigned registerIndex)
+void CPUModule::invalidateDecodePage(uint32_t page)
 {
-    switch (registerIndex) {
-        case IP0:           return "IP0";
-        case IP1:           return "IP1";
-        case SP:            return "SP";
-        case FP:            return "FP";
-        case LR:            return "LR";
-        case XZR:           return "XZR";
-        case SPECIAL_PC:    return "PC";
-        case SPECIAL_ESR:   return "ESR";
-        case SPECIAL_ELR:   return "ELR";
-        case SPECIAL_CPSR:  return "CPSR";
-        case SPECIAL_SPSR0: return "SPSR0";
-        case SPECIAL_SPSR1: return "SPSR1";
-        case SPECIAL_SPSR2: return "SPSR2";
-        case SPECIAL_SPSR3: return "SPSR3";
-        case SPECIAL_SPSR4: return "SPSR4";
-        case SPECIAL_SPSR5: return "SPSR5";
-        case SPECIAL_IVP:   return "IVP";
-        case SPECIAL_EVP:   return "EVP";
-        case SPECIAL_PDP:   return "PDP";
-        case SPECIAL_PFLA:  return "PFLA";
-    }
+    /* Every block link made so far might point into this page */
+    decodeCache[page].reset();
+    decodeCacheEpoch++;
 
-    if(registerIndex >= 0 && registerIndex < FISC_REGISTER_COUNT)
-        return "X" + std::to_string(registerIndex);
-    else
-        return "XNIL";
+    /* The page no longer holds what fisc-aot translated */
+    if (page < aotStalePages.size())
+        aotStalePages[page] = true;
 }
 
-std::string CPUModule::disassembleBCC(unsigned cc)
+void CPUModule::flushDecodeCache()
 {
-    switch (cc) {
-    case BEQ: return "BEQ";
-    case BNE: return "BNE";
-    case BLT: return "BLT";
-    case BLE: return "BLE";
-    case BGT: return "BGT";
-    case BGE: return "BGE";
-    case BLO: return "BLO";
-    case BLS: return "BLS";
-    case BHI: return "BHI";
-    case BHS: return "BHS";
-    case BMI: return "BMI";
-    case BPL: return "BPL";
-    case BVS: return "BVS";
-    case BVC: return "BVC";
-    default: return "<NIL>";
-    }
+    for (auto & page : decodeCache)
+        page.reset();
+    decodeCacheEpoch++;
 }
 
-std::string CPUModule::disassemble(Instruction * instruction)
+decode_block_t * CPUModule::lookupBlock(uint32_t virtualAddr)
 {
-    if(instruction->opcodeStr == "BCOND")
-        instruction->opcodeStr = disassembleBCC(instruction->ifmt_cb->rt);
+    /* Same rules as fetch(): blocks are indexed by physical page and
+       nothing is cached for unaligned code or for the IO address space */
+    uint32_t physicalAddr = virtualAddr;
+    if (cconf->cpsr.pg && mmu_translate(physicalAddr, virtualAddr, ENDIANNESS_TEXTSECT, FISC_TLB_INSTRUCTION, false) != FISC_RET_OK)
+        return nullptr;
 
-    std::string stringBuild = instruction->opcodeStr + " ";
-    switch (instruction->format) {
-        case IFMT_R:
-            if(instruction->ifmt_r->rd == XZR && instruction->ifmt_r->rn == XZR && instruction->ifmt_r->rm == XZR) {
-                stringBuild = "NOP";
-            } else {
-                if (instruction->opcode == SUBS && instruction->ifmt_r && instruction->ifmt_r->rd == XZR)
-                    stringBuild = "CMP";
-                else 
-                    stringBuild += disassembleRegister(instruction->ifmt_r->rd) + (instruction->opcode != BR && instruction->opcode != BRL ? "," : "");
-
-                if(instruction->opcode != BR && instruction->opcode != BRL)
-                    stringBuild += " " + disassembleRegister(instruction->ifmt_r->rn) + ", " + disassembleRegister(instruction->ifmt_r->rm);
+    uint32_t page = physicalAddr / FISC_PAGE_SIZE;
+
+    if (page >= decodeCache.size() || (page >= ioFirstPage && page <= ioLastPage) || (physicalAddr & 3))
+        return nullptr;
+
+    if (memory->wasPageWritten(page, coreID))
+        invalidateDecodePage(page);
+
+    if (!decodeCache[page])
+        decodeCache[page].reset(new decode_cache_page_t());
+
+    decode_cache_page_t * cachePage = decodeCache[page].get();
+    unsigned firstSlot = (physicalAddr % FISC_PAGE_SIZE) / (FISC_INSTRUCTION_SZ / 8);
+
+    if (cachePage->blocks[firstSlot])
+        return cachePage->blocks[firstSlot].get();
+
+    /* Form a new block: decode up to (and including) the first instruction that ends it */
+    unsigned length = 0;
+    bool indirect = false;
+
+    for (unsigned slot = firstSlot; slot < FISC_DECODE_CACHE_SLOTS; slot++) {
+        decode_cache_entry_t & entry = cachePage->entries[slot];
+
+        if (entry.op.handler == nullptr) {
+            uint32_t instruction = (uint32_t)memory->read(page * FISC_PAGE_SIZE + slot * (FISC_INSTRUCTION_SZ / 8), FISC_SZ_32, false, cconf->cpsr.pg, ENDIANNESS_TEXTSECT, false);
+            if (!decode(instruction, entry.op)) {
+                /* The block stops right before the undefined instruction */
+                entry.op.handler = nullptr;
+                break;
             }
+            entry.instruction = instruction;
+        }
+
+        length++;
+
+        if (endsBlock[entry.op.id]) {
+            Instruction * last = getInstructionInfo(&entry.op);
+            indirect = last->opcode == BR || last->opcode == BRL;
             break;
-        case IFMT_I:
-            stringBuild += disassembleRegister(instruction->ifmt_i->rd) + ", " + disassembleRegister(instruction->ifmt_i->rn) + ", " + disassembleConstant(instruction->ifmt_i->alu_immediate);
-            break;
-        case IFMT_D:
-            stringBuild += disassembleRegister(instruction->ifmt_d->rt) + ", [" + disassembleRegister(instruction->ifmt_d->rn) + ", " + disassembleConstant(instruction->ifmt_d->dt_address) + "]";
-            break;
-        case IFMT_B:
-            if(instruction->opcode == BL && instruction->ifmt_b->br_address == 0)
-                stringBuild = "HALT";
-            else
-                stringBuild += disassembleConstant(instruction->ifmt_b->br_address);
-            break;
-        case IFMT_CB:
-            stringBuild += disassembleConstant(instruction->ifmt_cb->cond_br_address);
+        }
+    }
+
+    if (length == 0)
+        return nullptr;
+
+    decode_block_t * block = new decode_block_t();
+    block->first = &cachePage->entries[firstSlot];
+    block->address = physicalAddr;
+    block->page = page;
+    block->length = (uint16_t)length;
+    block->indirect = indirect;
+    block->aot = findAOTBlock(physicalAddr);
+    cachePage->blocks[firstSlot].reset(block);
+    fuseBlock(block);
+    return block;
+}
+
+void CPUModule::fuseBlock(decode_block_t * block)
+{
+    /* Macro-op fusion. Marks the first instruction of every idiom compilers emit a lot:
+       - MOVZ followed by up to 3 MOVKs on the same register (a 64 bit constant): one register write
+       - SUBS / SUBIS / ANDS / ANDIS into XZR followed by BCOND (compare and branch): no dispatch in between
+       The threaded engine then runs the whole group at once. Groups never leave their block and none of
+       their instructions can fault or touch memory, so (as interrupts are only taken between blocks)
+       the state is exactly the same as if they had run one by one wherever it can be observed */
+    decode_cache_entry_t * entries = block->first;
+
+    for (unsigned i = 0; i < block->length; i++) {
+        decode_cache_entry_t & head = entries[i];
+        if (head.fusion != FISC_FUSION_NONE)
+            continue; /* Already fused (by a block starting before this one) */
+
+        switch (fusionRoles[head.op.id]) {
+        case FISC_FUSION_ROLE_MOVZ: {
+            uint64_t value = (uint64_t)(head.op.mov_immediate & 0xFFFF) << (16 * head.op.quadrant);
+            unsigned length = 1;
+            while (length < FISC_FUSION_MAX_LENGTH && i + length < block->length) {
+                const decoded_op_t & next = entries[i + length].op;
+                if (fusionRoles[next.id] != FISC_FUSION_ROLE_MOVK || next.rt != head.op.rt)
+                    break;
+                value &= ~(0xFFFFull << (16 * next.quadrant));
+                value |= (uint64_t)(next.mov_immediate & 0xFFFF) << (16 * next.quadrant);
+                length++;
+            }
+            if (length > 1) {
+                head.fusion = FISC_FUSION_MOVWIDE;
+                head.fusedLength = (uint8_t)length;
+                head.fusedValue = value;
+            }
             break;
-        case IFMT_IW:
-            stringBuild += disassembleRegister(instruction->ifmt_iw->rt) + ", " + disassembleConstant(instruction->ifmt_iw->mov_immediate) + ", LSL " + disassembleConstant(instruction->ifmt_iw->quadrant);
+        }
+        case FISC_FUSION_ROLE_COMPARE: {
+            if (head.op.rd != XZR || i + 1 >= block->length)
+                break;
+            const decoded_op_t & next = entries[i + 1].op;
+            if (fusionRoles[next.id] != FISC_FUSION_ROLE_BCOND || next.rt < BEQ || next.rt > BVC)
+                break; /* An invalid condition is left for BCOND itself to report */
+
+            int64_t addr = next.cond_br_address;
+            if (addr & (1 << (19 - 1))) addr = -((~addr + 1) & 0x7FFFF); /* Fix non 64-bit number signedness */
+            head.fusion = FISC_FUSION_CMPBRANCH;
+            head.fusedLength = 2;
+            head.fusedValue = (uint64_t)addr;
             break;
+        }
+        default: break;
+        }
     }
+}
 
-    return stringBuild;
+enum FISC_RETTYPE CPUModule::executeFused(const decode_cache_entry_t * entry, uint32_t pc)
+{
+    /* Runs the group that starts on 'entry' (at address 'pc') */
+    switch (entry->fusion) {
+    case FISC_FUSION_MOVWIDE:
+        /* MOVZ clears the register, so the whole group is a single write of its constant */
+        return writeRegister(entry->op.rt, entry->fusedValue, false, 0, 0, 0);
+    case FISC_FUSION_CMPBRANCH: {
+        /* The compare leaves its (lazy) flags behind exactly like it always does */
+        enum FISC_RETTYPE ret = entry->op.handler(&entry->op, this);
+        if (ret == FISC_RET_ERROR)
+            return ret;
+        writeRegister(SPECIAL_PC, pc + FISC_INSTRUCTION_SZ / 8, false, 0, 0, 0); /* The branch is relative to itself */
+        if (conditionHolds(entry[1].op.rt))
+            return branch((int32_t)(int64_t)entry->fusedValue, true);
+        return FISC_RET_OK;
+    }
+    default: return FISC_RET_ERROR;
+    }
+}
+
+/* Disassembly tables. The disassembler only looks things up on these
+   tables and prints into the caller's buffer (it never allocates) */
+static const char * const disasm_register_names[FISC_TOTAL_REGISTER_COUNT] = {
+    "X0",  "X1",  "X2",  "X3",  "X4",  "X5",  "X6",  "X7",
+    "X8",  "X9",  "X10", "X11", "X12", "X13", "X14", "X15",
+    "IP0", "IP1", "X18", "X19", "X20", "X21", "X22", "X23",
+    "X24", "X25", "X26", "X27", "SP",  "FP",  "LR",  "XZR",
+    "PC", "ESR", "ELR", "CPSR",
+    "SPSR0", "SPSR1", "SPSR2", "SPSR3", "SPSR4", "SPSR5",
+    "IVP", "EVP", "PDP", "PFLA", "CID"
+};
+
+static const char * const disasm_bcc_names[] = {
+    "<NIL>", "BEQ", "BNE", "BLT", "BLE", "BGT", "BGE", "BLO",
+    "BLS",   "BHI", "BHS", "BMI", "BPL", "BVS", "BVC"
+};
+
+enum DISASM_OPERAND {
+    DOP_NONE, /* No more operands                 */
+    DOP_RD,   /* Rd / Rt                          */
+    DOP_RN,   /* Rn                               */
+    DOP_RM,   /* Rm                               */
+    DOP_IMM,  /* The immediate of the format      */
+    DOP_MEM,  /* [Rn, dt_address]                 */
+    DOP_LSL   /* LSL quadrant                     */
+};
+
+#define DISASM_MAX_OPERANDS 3
+
+/* The operands of each instruction format (indexed by enum INSTRUCTION_FMT) */
+static const uint8_t disasm_operand_layouts[][DISASM_MAX_OPERANDS] = {
+    /* IFMT_R  */ { DOP_RD,  DOP_RN,   DOP_RM   },
+    /* IFMT_I  */ { DOP_RD,  DOP_RN,   DOP_IMM  },
+    /* IFMT_D  */ { DOP_RD,  DOP_MEM,  DOP_NONE },
+    /* IFMT_B  */ { DOP_IMM, DOP_NONE, DOP_NONE },
+    /* IFMT_CB */ { DOP_IMM, DOP_NONE, DOP_NONE },
+    /* IFMT_IW */ { DOP_RD,  DOP_IMM,  DOP_LSL  }
+};
+
+/* Special layouts of some R format instructions */
+static const uint8_t disasm_operand_layout_cmp[DISASM_MAX_OPERANDS] = { DOP_RN, DOP_RM,   DOP_NONE };
+static const uint8_t disasm_operand_layout_br[DISASM_MAX_OPERANDS]  = { DOP_RD, DOP_NONE, DOP_NONE };
+
+const char * CPUModule::disassembleRegister(unsigned registerIndex)
+{
+    return registerIndex < FISC_TOTAL_REGISTER_COUNT ? disasm_register_names[registerIndex] : "XNIL";
+}
+
+size_t CPUModule::disassemble(const decoded_op_t * op, char * buffer, size_t bufferSize)
+{
+    #define DISASM_APPEND(...) do { \
+        if (len < bufferSize) { int n = snprintf(buffer + len, bufferSize - len, __VA_ARGS__); if (n > 0) len += n; } \
+    } while(0)
+
+    if (buffer == nullptr || bufferSize == 0)
+        return 0;
+
+    Instruction * instruction = getInstructionInfo(op);
+    const char * mnemonic = instruction->opcodeStr.c_str();
+    const uint8_t * layout = disasm_operand_layouts[instruction->format];
+    size_t len = 0;
+
+    /* Handle the aliases first */
+    if (instruction->format == IFMT_R && op->rd == XZR && op->rn == XZR && op->rm == XZR) {
+        mnemonic = "NOP";
+        layout = nullptr;
+    }
+    else if (instruction->opcode == SUBS && op->rd == XZR) {
+        mnemonic = "CMP";
+        layout = disasm_operand_layout_cmp;
+    }
+    else if (instruction->opcode == BR || instruction->opcode == BRL) {
+        layout = disasm_operand_layout_br;
+    }
+    else if (instruction->opcode == BL && op->br_address == 0) {
+        mnemonic = "HALT";
+        layout = nullptr;
+    }
+    else if (instruction->opcode == BCOND) {
+        mnemonic = op->rt < sizeof(disasm_bcc_names) / sizeof(*disasm_bcc_names) ? disasm_bcc_names[op->rt] : disasm_bcc_names[0];
+    }
+
+    DISASM_APPEND("%s", mnemonic);
+
+    for (unsigned i = 0; layout != nullptr && i < DISASM_MAX_OPERANDS && layout[i] != DOP_NONE; i++) {
+        const char * separator = i == 0 ? " " : ", ";
+        switch (layout[i]) {
+            case DOP_RD:  DISASM_APPEND("%s%s", separator, disassembleRegister(op->rd)); break;
+            case DOP_RN:  DISASM_APPEND("%s%s", separator, disassembleRegister(op->rn)); break;
+            case DOP_RM:  DISASM_APPEND("%s%s", separator, disassembleRegister(op->rm)); break;
+            case DOP_IMM: DISASM_APPEND("%s%u", separator, op->imm); break;
+            case DOP_MEM: DISASM_APPEND("%s[%s, %u]", separator, disassembleRegister(op->rn), op->dt_address); break;
+            case DOP_LSL: DISASM_APPEND("%sLSL %u", separator, (unsigned)op->quadrant); break;
+        }
+    }
+
+    #undef DISASM_APPEND
+
+    /* The output might have been truncated */
+    return len < bufferSize ? len : bufferSize - 1;
 }
 
 std::string CPUModule::getCurrentCPUModeStr()
@@ -666,18 +1050,41 @@ std::string CPUModule::getCurrentCPUModeStr()
     }
 }
 
+Instruction * CPUModule::getInstructionInfo(const decoded_op_t * op)
+{
+    return cconf->instruction_list[op->id];
+}
+
 enum FISC_RETTYPE CPUModule::enterUndefMode()
 {
     cconf->cpsr.mode = FISC_CPU_MODE_UNDEFINED;
+    selectRegisterBank();
     return FISC_RET_OK;
 }
 
-enum FISC_RETTYPE CPUModule::mmu_translate(uint32_t & retVal, uint32_t virtualAddr, bool isLittleEndian)
+enum FISC_RETTYPE CPUModule::mmu_translate(uint32_t & retVal, uint32_t virtualAddr, bool isLittleEndian, enum FISC_TLB_SIDE side, bool isWrite)
 {
+    /* Look the page up on the TLB first */
+    uint32_t virtualPage = virtualAddr / FISC_PAGE_SIZE;
+    tlb_entry_t & tlbEntry = tlb[side][virtualPage % FISC_TLB_ENTRIES];
+
+    if (tlbEntry.virtualPage == virtualPage) {
+        /* Same permission checks as the page walk below */
+        if (!(tlbEntry.permissions & FISC_TLB_PERM_USER) && cconf->cpsr.mode == FISC_CPU_MODE_USER)
+            return triggerSoftException(EXC_PAGEFAULT);
+        if (!(tlbEntry.permissions & FISC_TLB_PERM_WRITE) && isWrite)
+            return triggerSoftException(EXC_PAGEFAULT);
+
+        retVal = (tlbEntry.physicalPage << 12) | (virtualAddr & 0xFFF);
+        return FISC_RET_OK;
+    }
+
+    /* TLB miss. Walk the page tables */
+
     /* Get the physical address of the page directory */
     uint32_t pageDirectoryAddress = (uint32_t)readRegister(SPECIAL_PDP);
     uint64_t memVal = (uint64_t)-1;
-    if (pageDirectoryAddress >= MEMORY_DEPTH) {
+    if (pageDirectoryAddress >= memory->size()) {
         DEBUG(DERROR, "The PDP (Page Directory Pointer) register holds a value that points beyond the memory size boundary.");
         return FISC_RET_ERROR;
     }
@@ -691,7 +1098,8 @@ enum FISC_RETTYPE CPUModule::mmu_translate(uint32_t & retVal, uint32_t virtualAd
     uint32_t tableEntryAddress = pageDirectoryAddress + (FISC_TABLES_PER_DIR * sizeof(page_table_t)) + (tableIdx * sizeof(page_table_entry_t));
 
     memVal = memory->read(tableEntryAddress, FISC_SZ_32, false, cconf->cpsr.pg, isLittleEndian, false);
-    page_table_entry_t * pageTableEntry = (page_table_entry_t*)(*(uint64_t*)&memVal);
+    uint32_t rawTableEntry = (uint32_t)memVal;
+    page_table_entry_t * pageTableEntry = (page_table_entry_t*)&rawTableEntry;
     
     /* See if the table is mapped */
     if (!pageTableEntry->present)
@@ -704,7 +1112,8 @@ enum FISC_RETTYPE CPUModule::mmu_translate(uint32_t & retVal, uint32_t virtualAd
     /* Calculate the physical address of the page */
     uint32_t pageAddress = tableAddress + (pageIdx * sizeof(page_t));
     memVal = memory->read(pageAddress, FISC_SZ_32, false, cconf->cpsr.pg, isLittleEndian, false);
-    page_t * pageEntry = (page_t*)(*(uint64_t*)&memVal);
+    uint32_t rawPageEntry = (uint32_t)memVal;
+    page_t * pageEntry = (page_t*)&rawPageEntry;
 
     /* See if the page is mapped */
     if (!pageEntry->present)
@@ -714,11 +1123,42 @@ enum FISC_RETTYPE CPUModule::mmu_translate(uint32_t & retVal, uint32_t virtualAd
     if (!pageEntry->user && cconf->cpsr.mode == FISC_CPU_MODE_USER)
         return triggerSoftException(EXC_PAGEFAULT);
 
+    /* Stores need both the table and the page to be writable */
+    if (isWrite && !(pageTableEntry->rw && pageEntry->rw))
+        return triggerSoftException(EXC_PAGEFAULT);
+
     /* Finally, get the physical address */
     retVal = (pageEntry->phys_addr << 12) | (virtualAddr & 0xFFF);
+
+    /* Cache the walk, and remember where its entries came from (writing there flushes the TLB) */
+    tlbEntry.virtualPage = virtualPage;
+    tlbEntry.physicalPage = pageEntry->phys_addr;
+    tlbEntry.permissions = (pageTableEntry->user && pageEntry->user ? FISC_TLB_PERM_USER : 0)
+                         | (pageTableEntry->rw && pageEntry->rw ? FISC_TLB_PERM_WRITE : 0);
+
+    uint32_t frames[] = { tableEntryAddress / FISC_PAGE_SIZE, pageAddress / FISC_PAGE_SIZE };
+    for (uint32_t frame : frames) {
+        if (frame < tlbTableFrames.size() && !tlbTableFrames[frame]) {
+            tlbTableFrames[frame] = true;
+            tlbTableFrameList.push_back(frame);
+        }
+    }
+
     return FISC_RET_OK;
 }
 
+void CPUModule::flushTLB()
+{
+    for (auto & side : tlb)
+        for (auto & entry : side)
+            entry.virtualPage = FISC_TLB_INVALID;
+
+    /* No cached walk depends on those frames anymore. They might go back to holding plain data */
+    for (uint32_t frame : tlbTableFrameList)
+        tlbTableFrames[frame] = false;
+    tlbTableFrameList.clear();
+}
+
 void CPUModule::dumpWarning(std::string problematicArg, std::string fullArg)
 {
     DEBUG(DWARN, "The provided argument '%s' in '%s' is not a valid integer", problematicArg.c_str(), fullArg.c_str());
@@ -757,9 +1197,9 @@ void CPUModule::dumpInternals()
                 DEBUG(DINFO2, "Dumping register contents (count: %d)", dumpRegCount >= FISC_TOTAL_REGISTER_COUNT ? FISC_TOTAL_REGISTER_COUNT : dumpRegCount);
                 for (uint16_t i = 0; i < dumpRegCount && i < FISC_TOTAL_REGISTER_COUNT; i++) {
                     if (i == SPECIAL_PC || i == SPECIAL_ESR || (i >= SPECIAL_CPSR && i <= SPECIAL_SPSR5))
-                        DEBUG(DINFO, "|%d| %s\t= 0x%X", i, disassembleRegister(i).c_str(), readRegister(i));
+                        DEBUG(DINFO, "|%d| %s\t= 0x%X", i, disassembleRegister(i), readRegister(i));
                     else
-                        DEBUG(DINFO, "|%d| %s\t= 0x%I64X", i, disassembleRegister(i).c_str(), readRegister(i));
+                        DEBUG(DINFO, "|%d| %s\t= 0x%I64X", i, disassembleRegister(i), readRegister(i));
                 }
                 DEBUG(DINFO2, "Dump completed");
                 DEBUG(DNORMALH, "\n");
@@ -891,11 +1331,26 @@ void CPUModule::dumpInternals()
     }
 }
 
-CPUModule::CPUModule() : RunPass(CPU_MODULE_PRIORITY)
+CPUModule::CPUModule() : RunPass(CPU_MODULE_PRIORITY),
+engine(FISC_ENGINE_REFERENCE), jitThreshold(FISC_JIT_DEFAULT_THRESHOLD),
+aotLibrary(nullptr), aotBlocks(nullptr), aotBlockCount(0), exclusiveValid(false),
+coreID(0), bootCore(this), pendingIRQs(0), coreSucceeded(false), coreInstructionsExecuted(0), flagsPending(false)
 {
 
 }
 
+CPUModule::CPUModule(unsigned coreID, CPUModule * bootCore, CPUConfigurator * cconf) : RunPass(CPU_MODULE_PRIORITY),
+ioconf(bootCore->ioconf), memory(bootCore->memory), cconf(cconf),
+engine(FISC_ENGINE_REFERENCE), jitThreshold(FISC_JIT_DEFAULT_THRESHOLD),
+aotLibrary(nullptr), aotBlocks(nullptr), aotBlockCount(0), exclusiveValid(false),
+coreID(coreID), bootCore(bootCore), pendingIRQs(0), coreSucceeded(false), coreInstructionsExecuted(0), flagsPending(false)
+{
+    /* A secondary core. It isn't registered on the target, but it still needs a name to print with */
+    passName = bootCore->passName + std::to_string(coreID);
+    passNameLong = bootCore->passNameLong + std::to_string(coreID);
+    setParentTargetContext(bootCore->getTarget());
+}
+
 enum PassRetcode CPUModule::init()
 {
     /* Fetch CPU Configurator Pass */
@@ -926,9 +1381,21 @@ enum PassRetcode CPUModule::init()
         (this should be done in CPUConfigurator, but we
         needed a convenient and quick way to grab the 
         pointer to this class) */
-    for (auto it = cconf->instruction_list.begin(); it != cconf->instruction_list.end(); it++)
-        it->second->passOwner = this;
-        
+    for (auto & instr : cconf->instruction_list)
+        instr->passOwner = this;
+
+    if (initCore() != PASS_RET_OK)
+        return PASS_RET_ERR;
+
+    /* Bring up the other cores */
+    return createSecondaryCores();
+}
+
+enum PassRetcode CPUModule::initCore()
+{
+    /* Point the register indices at this core's register file */
+    buildRegisterBanks();
+
     /* Initialize Program Counter */
     writeRegister(SPECIAL_PC, 0, false, 0, 0, 0);
 
@@ -942,97 +1409,357 @@ enum PassRetcode CPUModule::init()
 
     oldCPUMode = cconf->cpsr.mode;
 
-    /* Setup the stack pointer to the top of the memory */
-    writeRegister(SP, memory->size(), false, 0, 0, 0);
+    /* Prepare the decode cache. Its pages are only allocated once code is fetched from them */
+    decodeCache.clear();
+    decodeCache.resize((memory->size() + FISC_PAGE_SIZE - 1) / FISC_PAGE_SIZE);
+    ioFirstPage = IOMEMLOC / FISC_PAGE_SIZE;
+    ioLastPage  = (IOMEMLOC + (ioconf->ioSpaceSize ? ioconf->ioSpaceSize - 1 : 0)) / FISC_PAGE_SIZE;
+
+    /* Nothing was translated yet */
+    flushTLB();
+    features = 0;
+    featuresChanged = false;
+    tlbTableFrames.assign(decodeCache.size(), false);
+    tlbTableFrameList.clear();
+
+    /* Nothing was executed yet */
+    for (unsigned i = 0; i < FISC_MAX_INSTRUCTIONS; i++)
+        timesExecuted[i] = 0;
+    returnMessage = NULLSTR;
+
+    /* Select the execution engine */
+    engine = FISC_ENGINE_REFERENCE;
+    if (cmdHasOpt(CPU_FLAG_ENGINE)) {
+        std::string engineName = strTolower(cmdQuery(CPU_FLAG_ENGINE).second);
+        if (engineName == "threaded")
+            engine = FISC_ENGINE_THREADED;
+        else if (engineName == "jit")
+            engine = FISC_ENGINE_JIT;
+        else if (engineName != "reference")
+            DEBUG(DWARN, "Unknown execution engine '%s'. Using the reference engine", engineName.c_str());
+    }
+
+    if (engine == FISC_ENGINE_JIT) {
+        jitThreshold = FISC_JIT_DEFAULT_THRESHOLD;
+        if (cmdHasOpt(CPU_FLAG_JIT_THRESHOLD)) {
+            std::string thresholdStr = cmdQuery(CPU_FLAG_JIT_THRESHOLD).second;
+            try {
+                if (strIsNumber(thresholdStr))
+                    jitThreshold = (uint32_t)std::stoul(thresholdStr, nullptr, 0);
+            }
+            catch (const std::exception &) {
+                DEBUG(DWARN, "Invalid JIT threshold '%s'. Using %d", thresholdStr.c_str(), FISC_JIT_DEFAULT_THRESHOLD);
+            }
+        }
+
+        if (!FISC_HAS_JIT) {
+            DEBUG(DWARN, "The JIT can only run on x86-64 hosts. Using the threaded engine");
+            engine = FISC_ENGINE_THREADED;
+        }
+        else if (!jitCode.allocate(FISC_JIT_BUFFER_SIZE)) {
+            DEBUG(DWARN, "Could not allocate the JIT code buffer. Using the threaded engine");
+            engine = FISC_ENGINE_THREADED;
+        }
+    }
+
+    /* Control flow (and CPU state) changing instructions end the basic blocks */
+    for (unsigned i = 0; i < FISC_MAX_INSTRUCTIONS; i++)
+        endsBlock[i] = false;
+    for (auto & instr : cconf->instruction_list) {
+        switch (instr->opcode) {
+            case B: case BL: case BR: case BRL: case BCOND: case CBZ: case CBNZ:
+            case SINT: case RETI: case MSR: case LPDP:
+                endsBlock[instr->id] = true;
+                break;
+            default: break;
+        }
+    }
+    decodeCacheEpoch = 0;
+
+    /* Tell the threaded engine which instructions need their own label */
+    for (unsigned i = 0; i < FISC_MAX_INSTRUCTIONS; i++)
+        threadedOpKinds[i] = THREADED_OP_EXECUTE;
+    for (auto & instr : cconf->instruction_list) {
+        if (instr->opcode == BL && instr->format == IFMT_B)
+            threadedOpKinds[instr->id] = THREADED_OP_BRANCH_LINK;
+        else if (instr->format == IFMT_R && instr->opcode == ADD)
+            threadedOpKinds[instr->id] = THREADED_OP_ADD;
+        else if (instr->format == IFMT_I && instr->opcode == ADDI)
+            threadedOpKinds[instr->id] = THREADED_OP_ADDI;
+        else if (instr->format == IFMT_R && instr->opcode == SUB)
+            threadedOpKinds[instr->id] = THREADED_OP_SUB;
+        else if (instr->format == IFMT_I && instr->opcode == SUBI)
+            threadedOpKinds[instr->id] = THREADED_OP_SUBI;
+        else if (instr->format == IFMT_R && instr->opcode == AND)
+            threadedOpKinds[instr->id] = THREADED_OP_AND;
+        else if (instr->format == IFMT_R && instr->opcode == ORR)
+            threadedOpKinds[instr->id] = THREADED_OP_ORR;
+    }
+
+    /* And which ones can be fused together */
+    for (unsigned i = 0; i < FISC_MAX_INSTRUCTIONS; i++)
+        fusionRoles[i] = FISC_FUSION_ROLE_NONE;
+    for (auto & instr : cconf->instruction_list) {
+        if (instr->format == IFMT_IW && instr->opcode == MOVZ)
+            fusionRoles[instr->id] = FISC_FUSION_ROLE_MOVZ;
+        else if (instr->format == IFMT_IW && instr->opcode == MOVK)
+            fusionRoles[instr->id] = FISC_FUSION_ROLE_MOVK;
+        else if ((instr->format == IFMT_R && (instr->opcode == SUBS || instr->opcode == ANDS)) ||
+                 (instr->format == IFMT_I && (instr->opcode == SUBIS || instr->opcode == ANDIS)))
+            fusionRoles[instr->id] = FISC_FUSION_ROLE_COMPARE;
+        else if (instr->format == IFMT_CB && instr->opcode == BCOND)
+            fusionRoles[instr->id] = FISC_FUSION_ROLE_BCOND;
+
+        if (fusionRoles[instr->id] == FISC_FUSION_ROLE_MOVZ || fusionRoles[instr->id] == FISC_FUSION_ROLE_COMPARE)
+            threadedOpKinds[instr->id] = THREADED_OP_FUSIBLE;
+    }
+
+    /* Load the ahead-of-time translation of this program (before any block gets formed) */
+    aotStalePages.assign(decodeCache.size(), false);
+    if (cmdHasOpt(CPU_FLAG_AOT)) {
+        if (!cmdHasOpt(CPU_FLAG_ENGINE))
+            engine = FISC_ENGINE_THREADED;
+        else if (engine == FISC_ENGINE_REFERENCE)
+            DEBUG(DWARN, "The reference engine never runs ahead-of-time translated code");
+        loadAOTLibrary(cmdQuery(CPU_FLAG_AOT).second);
+    }
+
+    /* Warm up the decode cache with what the previous runs of this program left behind */
+    if (cmdHasOpt(CPU_FLAG_TCACHE)) {
+        tcacheDir = cmdQuery(CPU_FLAG_TCACHE).second;
+        loadTranslationCache();
+    }
+
+    /* Setup the stack pointer to the top of the memory (each core gets its own stack below the previous core's) */
+    writeRegister(SP, memory->size() - (uint64_t)coreID * FISC_CORE_STACK_SIZE, false, 0, 0, 0);
+
+    /* Start at the program's entry point */
+    writeRegister(SPECIAL_PC, memory->getEntryPoint(), false, 0, 0, 0);
 
     /* We're good to go */
     return PASS_RET_OK;
 }
 
-enum PassRetcode CPUModule::finit()
+enum PassRetcode CPUModule::createSecondaryCores()
 {
-    /* TODO */
+    unsigned coreCount = 1;
+    if (cmdHasOpt(CPU_FLAG_CORES)) {
+        std::string coresStr = cmdQuery(CPU_FLAG_CORES).second;
+        unsigned long requested = 0;
+        try {
+            if (strIsNumber(coresStr))
+                requested = std::stoul(coresStr, nullptr, 0);
+        }
+        catch (const std::exception &) {
+            requested = 0;
+        }
+
+        /* Every core gets FISC_CORE_STACK_SIZE bytes of stack, carved from the top of the memory */
+        uint64_t coresThatFit = memory->size() / FISC_CORE_STACK_SIZE;
+        if (requested < 1 || requested > FISC_MAX_CORES)
+            DEBUG(DWARN, "The machine can only have 1 to %d cores. Using 1 core", FISC_MAX_CORES);
+        else if (requested > coresThatFit)
+            DEBUG(DWARN, "%lu cores need %llu bytes of stack, but the memory only has %llu bytes. Using 1 core",
+                requested, (unsigned long long)requested * FISC_CORE_STACK_SIZE, (unsigned long long)memory->size());
+        else
+            coreCount = (unsigned)requested;
+    }
+
+    cores.assign(1, this);
+
+    /* Every other core gets a register file of its own (a copy of the configured one)
+       and shares everything else: the memory, the IO devices and the instructions */
+    for (unsigned id = 1; id < coreCount; id++) {
+        std::unique_ptr<CPUConfigurator> coreConf(new CPUConfigurator(*cconf));
+        std::unique_ptr<CPUModule> core(new CPUModule(id, this, coreConf.get()));
+
+        if (core->initCore() != PASS_RET_OK) {
+            DEBUG(DERROR, "Could not initialize core %d", id);
+            return PASS_RET_ERR;
+        }
+
+        cores.push_back(core.get());
+        secondaryConfs.push_back(std::move(coreConf));
+        secondaryCores.push_back(std::move(core));
+    }
+
+    if (coreCount > 1)
+        DEBUG(DINFO, "The machine has %d cores", coreCount);
+
     return PASS_RET_OK;
 }
 
-enum PassRetcode CPUModule::run()
+void CPUModule::secondaryCoreLauncher(void * coreArg)
 {
-    DEBUG(DGOOD," -- EXECUTING CPU (mode: %s) --%s", getCurrentCPUModeStr().c_str(), memory->showExecution ? "\n" : "");
-    
-    /* 
-    -- CPU ALGORITHM --
-        1-Fetch
-        2-Decode
-        3-Execute
-        4-Memory Access
-        5-Writeback
+    CPUModule * core = (CPUModule*)coreArg;
+    uint32_t instructionsExecuted = 1;
+    core->coreSucceeded = core->runCore(instructionsExecuted);
+    core->coreInstructionsExecuted = instructionsExecuted - 1;
+}
 
-        * Repeat *
-    */
+void CPUModule::startSecondaryCores()
+{
+    for (auto & core : secondaryCores)
+        secondaryThreads.push_back(std::unique_ptr<thread>(new thread(secondaryCoreLauncher, (void*)core.get())));
+}
 
-    bool successfulExecution = false;
-    std::string disassembledInstruction = NULLSTR;
-    uint32_t instructionsExecuted = 1;
+void CPUModule::joinSecondaryCores()
+{
+    /* The machine only stops once every core has halted */
+    for (size_t i = 0; i < secondaryThreads.size(); i++) {
+        secondaryThreads[i]->join();
+        CPUModule * core = secondaryCores[i].get();
+        DEBUG(core->coreSucceeded ? DGOOD : DERROR, " -- CORE %d DONE EXECUTING (%d instructions executed) --", core->coreID, core->coreInstructionsExecuted);
+    }
+    secondaryThreads.clear();
+}
+
+unsigned CPUModule::getCoreID()
+{
+    return coreID;
+}
+
+bool CPUModule::raiseInterrupt(unsigned intCode)
+{
+    if (intCode >= FISC_IRQ_LINES)
+        return false;
+
+    /* Safe to call from any thread. The core takes it on its next instruction (or block)
+       boundary, once its interrupts are enabled and it's not servicing another one. Until
+       then it stays pending (raising it again before that doesn't queue a second one) */
+    pendingIRQs.fetch_or(1ull << intCode, std::memory_order_release);
+    return true;
+}
+
+bool CPUModule::sendInterProcessorInterrupt(unsigned targetCore, unsigned intCode)
+{
+    std::vector<CPUModule*> & machineCores = bootCore->cores;
+    if (targetCore >= machineCores.size())
+        return false;
+    return machineCores[targetCore]->raiseInterrupt(intCode);
+}
+
+bool CPUModule::pollInterrupts()
+{
+    /* Runs between two instructions, with the PC already on the next one to execute */
+    if (!areInterruptsEnabled() || isInsideInterrupt)
+        return false;
+
+    uint64_t pending = pendingIRQs.load(std::memory_order_acquire);
+    if (pending == 0)
+        return false;
+
+    /* The lowest interrupt code has the highest priority */
+    unsigned intCode = 0;
+    while (!(pending & 1)) {
+        pending >>= 1;
+        intCode++;
+    }
+    pendingIRQs.fetch_and(~(1ull << intCode), std::memory_order_acq_rel);
+
+    /* switchContext() returns to the instruction after the one that got interrupted,
+       which here is the instruction that just finished (the one before the PC) */
+    cconf->pc -= FISC_INSTRUCTION_SZ / 8;
+    bool delivered = triggerHardInterrupt(intCode) == FISC_RET_OK;
+    bool redirected = delivered || generatedException;
+
+    if (!delivered) {
+        /* The interrupt stays pending until it can be delivered */
+        pendingIRQs.fetch_or(1ull << intCode, std::memory_order_acq_rel);
+        if (!generatedException)
+            cconf->pc += FISC_INSTRUCTION_SZ / 8;
+    }
+
+    /* The PC is already on the next instruction to run (the first one of the handler, if any) */
+    isBranching = false;
+    generatedException = false;
+    generatedExternalException = false;
+    generatedInterrupt = false;
+    generatedExternalInterrupt = false;
+    return redirected;
+}
+
+enum PassRetcode CPUModule::finit()
+{
+    for (auto & core : secondaryCores)
+        core->unloadAOTLibrary();
+    unloadAOTLibrary();
+    return PASS_RET_OK;
+}
+
+template<unsigned Features>
+bool CPUModule::runReferenceAs(uint32_t & instructionsExecuted)
+{
+    char disassembledInstruction[FISC_DISASSEMBLY_MAX_SZ] = "";
     uint32_t instruction = (uint32_t)-1;
     uint32_t pc_copy = (uint32_t)-1;
 
     /* On every loop:  */
     while (1)
     {
-        /* Stage 1 - Fetch instruction */
-        instruction = (uint32_t)mmu_read((pc_copy = (uint32_t)readRegister(SPECIAL_PC)), FISC_SZ_32, false, ENDIANNESS_TEXTSECT, false);
+        /* Interrupts raised by the devices (and the other cores) are taken between instructions */
+        if (pendingIRQs.load(std::memory_order_relaxed) != 0)
+            pollInterrupts();
 
-        /* Stage 2 - Decode instruction */
-        Instruction * decodedInstruction = decode(instruction);
-        if(instruction == (uint32_t)-1 || decodedInstruction == nullptr || !decodedInstruction->initialized) {
+        /* Paging was toggled. Let runReference() switch over to the matching instantiation */
+        if (featuresChanged)
+            return true;
+
+        /* Stages 1 and 2 - Fetch and decode instruction (served from the decode cache whenever possible) */
+        const decoded_op_t * decodedOp = fetchAs<Features>((pc_copy = (uint32_t)readRegister(SPECIAL_PC)), instruction);
+        if(instruction == (uint32_t)-1 || decodedOp == nullptr) {
             DEBUG(DERROR, "Unhandled exception: instruction 0x%X (opcode 0x%X, @PC 0x%X) is undefined. Terminating.", instruction, OPCODE_MASK(instruction), pc_copy);
             enterUndefMode();
             triggerSoftException(EXC_INVALOPC);
-            break;
+            return false;
         }
-        disassembledInstruction = disassemble(decodedInstruction); /* Also disassemble instruction while we're at it */
+        Instruction * decodedInstruction = getInstructionInfo(decodedOp);
 
-        if(memory->showExecution)
-            DEBUG(DINFO, "|%d| @PC 0x%X = 0x%X\t|%d| %s", instructionsExecuted, pc_copy, instruction, decodedInstruction->timesExecuted + 1, disassembledInstruction.c_str());
+        if(Features & FISC_FEATURE_TRACE) {
+            /* Only disassemble the instruction if someone is going to read it */
+            disassemble(decodedOp, disassembledInstruction, sizeof(disassembledInstruction));
+            DEBUG(DINFO, "|%d| @PC 0x%X = 0x%X\t|%d| %s", instructionsExecuted, pc_copy, instruction, timesExecuted[decodedOp->id] + 1, disassembledInstruction);
+        }
         
-        if (decodedInstruction->opcode == BL && decodedInstruction->ifmt_b->br_address == 0) {
+        if (decodedInstruction->opcode == BL && decodedOp->br_address == 0) {
             instructionsExecuted++;
-            decodedInstruction->timesExecuted++;
-            successfulExecution = true;
-            break;
+            timesExecuted[decodedOp->id]++;
+            return true;
         }
 
         /* Stages 3, 4 and 5 - Execute instruction, Access Memory and Write back to the registers */
-        
-        enum FISC_RETTYPE ret = decodedInstruction->operation(decodedInstruction, decodedInstruction->passOwner);
+        if (Features & FISC_FEATURE_TRACE)
+            returnMessage = NULLSTR; /* Whatever gets printed below belongs to this instruction */
+
+        enum FISC_RETTYPE ret = decodedOp->handler(decodedOp, this);
         instructionsExecuted++;
-        decodedInstruction->timesExecuted++;
+        timesExecuted[decodedOp->id]++;
         if (ret != FISC_RET_OK) {
-            if(isDebuggingEnabled() && memory->showExecution) {
+            if((Features & FISC_FEATURE_TRACE) && isDebuggingEnabled()) {
                 /* Just for pretty output */
                 DEBUG(DNORMALH, "\t\t| ");
                 if(ret == FISC_RET_ERROR)
-                    PRINTC(DERROR, "ERROR: %s", decodedInstruction->retStr.c_str());
+                    PRINTC(DERROR, "ERROR: %s", returnMessage.c_str());
                 else if(ret == FISC_RET_INFO)
-                    PRINTC(DINFO2, "INFO: %s", decodedInstruction->retStr.c_str());
+                    PRINTC(DINFO2, "INFO: %s", returnMessage.c_str());
                 else if(ret == FISC_RET_WARNING)
-                    PRINTC(DWARN, "WARNING: %s", decodedInstruction->retStr.c_str());
+                    PRINTC(DWARN, "WARNING: %s", returnMessage.c_str());
             }
 
             if (ret == FISC_RET_ERROR) {
                 DEBUG(DERROR, "Unhandled exception: execution of instruction 0x%X (opcode 0x%X, @PC 0x%X) failed. Terminating.", instruction, OPCODE_MASK(instruction), pc_copy);
                 enterUndefMode();
                 triggerSoftException(EXC_INVALOPC);
-                break;
+                return false;
             }
         }
         else {
             /* Instruction executed successfully */
-            if(isDebuggingEnabled() && memory->showExecution) {
+            if((Features & FISC_FEATURE_TRACE) && isDebuggingEnabled()) {
                 /* Just for pretty output */
-                if (disassembledInstruction.find("NOP") != std::string::npos) {
+                if (strstr(disassembledInstruction, "NOP") != nullptr) {
                     /* I really need to improve the tab alignment code... */
-                    if(decodedInstruction->timesExecuted < 10)
+                    if(timesExecuted[decodedOp->id] < 10)
                         DEBUG(DNORMALH, "\t\t\t\t| OK");
                     else
                         DEBUG(DNORMALH, "\t\t\t| OK");
@@ -1042,11 +1769,6 @@ enum PassRetcode CPUModule::run()
                 }
             }
         }
-        
-        /*********** T O D O *********/
-        if(generatedExternalInterrupt)
-            printf("\nGenerated interrupt");
-        /*********** T O D O *********/
 
         /* Now increment the Program Counter value (always aligned by 4 bytes / 32 bits, with or without the AE flag enabled) */
         if(!isBranching && !generatedException && !generatedExternalException && !generatedExternalInterrupt && !generatedInterrupt)
@@ -1057,6 +1779,718 @@ enum PassRetcode CPUModule::run()
         generatedInterrupt = false;
         generatedExternalInterrupt = false;
     }
+}
+
+bool CPUModule::runReference(uint32_t & instructionsExecuted)
+{
+    static bool (CPUModule::* const loops[FISC_FEATURE__COMBINATIONS])(uint32_t &) = {
+        &CPUModule::runReferenceAs<0>,
+        &CPUModule::runReferenceAs<FISC_FEATURE_TRACE>,
+        &CPUModule::runReferenceAs<FISC_FEATURE_PAGING>,
+        &CPUModule::runReferenceAs<FISC_FEATURE_TRACE | FISC_FEATURE_PAGING>
+    };
+
+    /* Run the loop that was built for the features in use, until the CPU halts or they change */
+    bool success;
+    do {
+        featuresChanged = false;
+        success = (this->*loops[features])(instructionsExecuted);
+    } while (success && featuresChanged);
+    return success;
+}
+
+bool CPUModule::jitCompileBlock(decode_block_t * block)
+{
+    /* Translates a block into x86-64 code that calls the instruction handlers back to back.
+       The guest registers stay where they are (on the CPU Configurator) and loads / stores go
+       through mmu_read / mmu_write, same as always. What goes away is all of the dispatching:
+       the PC, the counters and the flags are updated / checked inline.
+       Returns false if the code buffer is full */
+    JITCodeBuffer & code = jitCode;
+    std::vector<size_t> toBlockExit;
+    std::vector<size_t> toError;
+    std::vector<size_t> toEpilogue;
+
+    void * entryPoint = code.begin();
+
+    /* Prologue: rbx = CPU, r14 = instructionsExecuted. Keep the stack
+       16 byte aligned and reserve the shadow space for the callees */
+    code.push(X64_RBX);
+    code.push(X64_R14);
+    code.subRsp(40);
+    code.movReg(X64_RBX, X64_ARG0);
+    code.movReg(X64_R14, X64_ARG1);
+
+    bool * const flags[] = { &isBranching, &generatedException, &generatedExternalException, &generatedExternalInterrupt, &generatedInterrupt };
+
+    for (unsigned i = 0; i < block->length; i++) {
+        const decoded_op_t * op = &block->first[i].op;
+        Instruction * info = getInstructionInfo(op);
+
+        if (info->opcode == BL && op->br_address == 0) {
+            /* BL 0 halts the CPU. The dispatcher takes care of it */
+            code.movEaxImm(JIT_EXIT_HALT);
+            toEpilogue.push_back(code.jmp());
+            break;
+        }
+
+        /* ret = op->handler(op, cpu) */
+        code.movImm64(X64_ARG0, (uint64_t)(uintptr_t)op);
+        code.movReg(X64_ARG1, X64_RBX);
+        code.movImm64(X64_RAX, (uint64_t)(uintptr_t)op->handler);
+        code.call(X64_RAX);
+
+        /* (*instructionsExecuted)++; timesExecuted[op->id]++ */
+        code.addMem32Imm(X64_R14, 1);
+        code.movImm64(X64_R11, (uint64_t)(uintptr_t)&timesExecuted[op->id]);
+        code.addMem32Imm(X64_R11, 1);
+
+        /* if (ret == FISC_RET_ERROR) exit */
+        code.cmpEaxImm(FISC_RET_ERROR);
+        toError.push_back(code.je());
+
+        /* A taken branch, an exception or an interrupt ends the block right here */
+        for (auto flag : flags) {
+            code.movImm64(X64_R11, (uint64_t)(uintptr_t)flag);
+            code.cmpMem8Imm(X64_R11, 0);
+            toBlockExit.push_back(code.jne());
+        }
+
+        /* PC += 4 */
+        code.movImm64(X64_R11, (uint64_t)(uintptr_t)&cconf->pc);
+        code.movMem32Imm(X64_R11, block->address + (i + 1) * (FISC_INSTRUCTION_SZ / 8));
+
+        /* Let the dispatcher check for self modifying code after every store */
+        if (isStoreOpcode(info->opcode))
+            break;
+    }
+
+    /* Block exit (also reached by falling off the end of the block) */
+    for (auto at : toBlockExit)
+        code.bindRel32(at);
+    code.movEaxImm(JIT_EXIT_BLOCK);
+    toEpilogue.push_back(code.jmp());
+
+    /* Error exit */
+    for (auto at : toError)
+        code.bindRel32(at);
+    code.movEaxImm(JIT_EXIT_ERROR);
+
+    /* Epilogue (eax already holds the exit reason) */
+    for (auto at : toEpilogue)
+        code.bindRel32(at);
+    code.addRsp(40);
+    code.pop(X64_R14);
+    code.pop(X64_RBX);
+    code.ret();
+
+    if (!code.commit())
+        return false;
+
+    block->native = entryPoint;
+    return true;
+}
+
+bool CPUModule::isStoreOpcode(enum OPCODE opcode)
+{
+    switch (opcode) {
+        case STR_: case STRB: case STRH: case STRW: case STXR:
+        case STRR: case STRBR: case STRHR: case STRWR: case STXRR:
+        case STRS: case STRD:
+        case CAS: case LDADD: case SWP:
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::string CPUModule::getTranslationCachePath()
+{
+    char name[64];
+    snprintf(name, sizeof(name), "fisc-%016llx-%016llx" FISC_TCACHE_EXTENSION,
+        (unsigned long long)memory->getProgramHash(), (unsigned long long)tcacheBuildID((uint32_t)cconf->instruction_list.size()));
+
+    std::string path = tcacheDir;
+    if (!path.empty() && path.back() != '/' && path.back() != '\\')
+        path += '/';
+    return path + name;
+}
+
+void CPUModule::loadTranslationCache()
+{
+    std::string path = getTranslationCachePath();
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    if (!file.is_open())
+        return; /* Nothing cached for this program yet */
+
+    tcache_header_t header;
+    if (!file.read((char*)&header, sizeof(header))
+        || memcmp(header.magic, FISC_TCACHE_MAGIC, sizeof(header.magic))
+        || header.programHash != memory->getProgramHash()
+        || header.buildID != tcacheBuildID((uint32_t)cconf->instruction_list.size()))
+    {
+        DEBUG(DWARN, "Ignoring the stale translation cache '%s'", path.c_str());
+        return;
+    }
+
+    std::vector<tcache_instruction_t> instructions(header.instructionCount);
+    std::vector<tcache_block_t> blocks(header.blockCount);
+    if ((header.instructionCount && !file.read((char*)instructions.data(), instructions.size() * sizeof(tcache_instruction_t)))
+        || (header.blockCount && !file.read((char*)blocks.data(), blocks.size() * sizeof(tcache_block_t))))
+    {
+        DEBUG(DWARN, "The translation cache '%s' is truncated", path.c_str());
+        return;
+    }
+
+    unsigned loadedInstructions = 0;
+    unsigned loadedBlocks = 0;
+
+    for (auto & record : instructions) {
+        uint32_t page = record.address / FISC_PAGE_SIZE;
+        if (page >= decodeCache.size() || (page >= ioFirstPage && page <= ioLastPage) || (record.address & 3) || record.id >= cconf->instruction_list.size())
+            continue;
+
+        /* Only trust the records that still match what's in memory */
+        if ((uint32_t)memory->read(record.address, FISC_SZ_32, false, false, ENDIANNESS_TEXTSECT, false) != record.instruction)
+            continue;
+
+        if (!decodeCache[page])
+            decodeCache[page].reset(new decode_cache_page_t());
+
+        decode_cache_entry_t & entry = decodeCache[page]->entries[(record.address % FISC_PAGE_SIZE) / (FISC_INSTRUCTION_SZ / 8)];
+        entry.instruction = record.instruction;
+        entry.op.handler = cconf->instruction_list[record.id]->operation;
+        entry.op.imm = record.imm;
+        entry.op.rd = record.rd;
+        entry.op.rn = record.rn;
+        entry.op.rm = record.rm;
+        entry.op.id = record.id;
+        loadedInstructions++;
+    }
+
+    /* Paging is disabled at this point, so the block addresses are also their PCs */
+    for (auto & record : blocks) {
+        decode_block_t * block = lookupBlock(record.address);
+        if (block != nullptr) {
+            block->hotness = record.hotness;
+            loadedBlocks++;
+        }
+    }
+
+    DEBUG(DINFO, "Loaded %d instructions and %d blocks from the translation cache '%s'", loadedInstructions, loadedBlocks, path.c_str());
+}
+
+void CPUModule::saveTranslationCache()
+{
+    std::vector<tcache_instruction_t> instructions;
+    std::vector<tcache_block_t> blocks;
+
+    for (uint32_t page = 0; page < decodeCache.size(); page++) {
+        if (!decodeCache[page])
+            continue;
+
+        for (uint32_t slot = 0; slot < FISC_DECODE_CACHE_SLOTS; slot++) {
+            uint32_t address = page * FISC_PAGE_SIZE + slot * (FISC_INSTRUCTION_SZ / 8);
+            decode_cache_entry_t & entry = decodeCache[page]->entries[slot];
+
+            if (entry.op.handler != nullptr) {
+                tcache_instruction_t record;
+                record.address = address;
+                record.instruction = entry.instruction;
+                record.imm = entry.op.imm;
+                record.rd = entry.op.rd;
+                record.rn = entry.op.rn;
+                record.rm = entry.op.rm;
+                record.id = entry.op.id;
+                instructions.push_back(record);
+            }
+
+            if (decodeCache[page]->blocks[slot]) {
+                tcache_block_t record;
+                record.address = address;
+                record.hotness = decodeCache[page]->blocks[slot]->hotness;
+                blocks.push_back(record);
+            }
+        }
+    }
+
+    tcache_header_t header;
+    memcpy(header.magic, FISC_TCACHE_MAGIC, sizeof(header.magic));
+    header.programHash = memory->getProgramHash();
+    header.buildID = tcacheBuildID((uint32_t)cconf->instruction_list.size());
+    header.instructionCount = (uint32_t)instructions.size();
+    header.blockCount = (uint32_t)blocks.size();
+
+    std::string path = getTranslationCachePath();
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        DEBUG(DWARN, "Could not write the translation cache '%s'", path.c_str());
+        return;
+    }
+
+    file.write((char*)&header, sizeof(header));
+    if (!instructions.empty())
+        file.write((char*)instructions.data(), instructions.size() * sizeof(tcache_instruction_t));
+    if (!blocks.empty())
+        file.write((char*)blocks.data(), blocks.size() * sizeof(tcache_block_t));
+}
+
+bool CPUModule::loadAOTLibrary(const std::string & path)
+{
+    /* Loads a shared library made by fisc-aot. It's only used if it was made from the very same program image */
+#ifdef _WIN32
+    HMODULE library = LoadLibraryA(path.c_str());
+    #define AOT_SYMBOL(name) (void*)GetProcAddress(library, name)
+#else
+    void * library = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    #define AOT_SYMBOL(name) dlsym(library, name)
+#endif
+
+    if (library == nullptr) {
+        DEBUG(DWARN, "Could not load the ahead-of-time translated program '%s'", path.c_str());
+        return false;
+    }
+
+    const uint32_t         * abiVersion  = (const uint32_t*)AOT_SYMBOL(FISC_AOT_SYMBOL_ABI_VERSION);
+    const uint64_t         * programHash = (const uint64_t*)AOT_SYMBOL(FISC_AOT_SYMBOL_PROGRAM_HASH);
+    const uint32_t         * blockCount  = (const uint32_t*)AOT_SYMBOL(FISC_AOT_SYMBOL_BLOCK_COUNT);
+    const fisc_aot_block_t * blocks      = (const fisc_aot_block_t*)AOT_SYMBOL(FISC_AOT_SYMBOL_BLOCKS);
+    #undef AOT_SYMBOL
+
+    const char * problem = nullptr;
+    if (abiVersion == nullptr || programHash == nullptr || blockCount == nullptr || blocks == nullptr)
+        problem = "it was not made by fisc-aot";
+    else if (*abiVersion != FISC_AOT_ABI_VERSION)
+        problem = "it was made by a different version of fisc-aot";
+    else if (*programHash != memory->getProgramHash())
+        problem = "it was made from a different program";
+
+    if (problem != nullptr) {
+        DEBUG(DWARN, "Ignoring the ahead-of-time translated program '%s': %s", path.c_str(), problem);
+#ifdef _WIN32
+        FreeLibrary(library);
+#else
+        dlclose(library);
+#endif
+        return false;
+    }
+
+    aotLibrary = (void*)library;
+    aotBlocks = blocks;
+    aotBlockCount = *blockCount;
+
+    aotAPI.abiVersion = FISC_AOT_ABI_VERSION;
+    aotAPI.advance = [](void * cpu, uint32_t instructions) {
+        CPUModule * self = (CPUModule*)cpu;
+        self->writeRegister(SPECIAL_PC, self->readRegister(SPECIAL_PC) + instructions * (FISC_INSTRUCTION_SZ / 8), false, 0, 0, 0);
+    };
+    aotAPI.step = [](void * cpu, uint32_t * instructionsExecuted) -> uint32_t {
+        return ((CPUModule*)cpu)->aotStep(instructionsExecuted);
+    };
+
+    DEBUG(DINFO, "Loaded %d ahead-of-time translated blocks from '%s'", aotBlockCount, path.c_str());
+    return true;
+}
+
+void CPUModule::unloadAOTLibrary()
+{
+    if (aotLibrary == nullptr)
+        return;
+
+    /* The blocks point into the library */
+    flushDecodeCache();
+
+#ifdef _WIN32
+    FreeLibrary((HMODULE)aotLibrary);
+#else
+    dlclose(aotLibrary);
+#endif
+    aotLibrary = nullptr;
+    aotBlocks = nullptr;
+    aotBlockCount = 0;
+}
+
+void * CPUModule::findAOTBlock(uint32_t physicalAddr)
+{
+    if (aotLibrary == nullptr || aotStalePages[physicalAddr / FISC_PAGE_SIZE])
+        return nullptr;
+
+    const fisc_aot_block_t * end = aotBlocks + aotBlockCount;
+    const fisc_aot_block_t * found = std::lower_bound(aotBlocks, end, physicalAddr,
+        [](const fisc_aot_block_t & block, uint32_t address) { return block.address < address; });
+
+    return found != end && found->address == physicalAddr ? (void*)found->code : nullptr;
+}
+
+uint32_t CPUModule::aotStep(uint32_t * instructionsExecuted)
+{
+    /* Interprets the single instruction at the PC, for the translated code (which only lifts the simple ones) */
+    uint32_t instruction = (uint32_t)-1;
+    uint32_t pc_copy = (uint32_t)readRegister(SPECIAL_PC);
+
+    const decoded_op_t * decodedOp = fetch(pc_copy, instruction);
+    if (decodedOp == nullptr)
+        return FISC_AOT_EXIT_ERROR;
+
+    enum FISC_RETTYPE ret = decodedOp->handler(decodedOp, this);
+    (*instructionsExecuted)++;
+    timesExecuted[decodedOp->id]++;
+
+    if (ret == FISC_RET_ERROR)
+        return FISC_AOT_EXIT_ERROR;
+
+    if (isBranching || generatedException || generatedExternalException || generatedExternalInterrupt || generatedInterrupt)
+        return FISC_AOT_EXIT_BLOCK;
+
+    writeRegister(SPECIAL_PC, pc_copy + FISC_INSTRUCTION_SZ / 8, false, 0, 0, 0);
+
+    /* Self modifying code. The rest of the translated block is out of date */
+    uint32_t page = pc_copy / FISC_PAGE_SIZE;
+    if (page < decodeCache.size() && memory->wasPageWritten(page, coreID)) {
+        invalidateDecodePage(page);
+        return FISC_AOT_EXIT_BLOCK;
+    }
+
+    return FISC_AOT_CONTINUE;
+}
+
+bool CPUModule::runThreaded(uint32_t & instructionsExecuted)
+{
+    /* Threaded engine. Straight line code is grouped into basic blocks (see lookupBlock()),
+       whose decoded instructions are walked entry by entry, jumping (computed goto, or a switch
+       where there is none) to the label of each instruction's kind. The hottest instructions have
+       their bodies inlined on their own label. The rest share one that calls their handler.
+       Blocks ending in direct branches are chained to their successors and BR / BRL targets go
+       through a small indirect branch target cache, so most of the time we never look the PC up.
+       Branches, exceptions and interrupts are only dealt with at block boundaries.
+       The instruction semantics are the same as the handlers the reference loop calls */
+    decode_block_t             * block     = nullptr; /* The block being executed                      */
+    decode_block_t             * previous  = nullptr; /* The block we just left (if it can be chained) */
+    const decode_cache_entry_t * entry     = nullptr;
+    const decoded_op_t         * decodedOp = nullptr;
+    enum FISC_RETTYPE ret = FISC_RET_NULL;
+    uint32_t instruction = (uint32_t)-1;
+    uint32_t pc_copy = (uint32_t)-1;
+    uint32_t epoch = 0;
+    unsigned remaining = 0;
+    unsigned blockExit = FISC_BLOCK_EXIT_FALLTHROUGH;
+
+#if FISC_HAS_COMPUTED_GOTO
+    static void * const kindLabels[THREADED_OP__COUNT] = {
+        &&op_execute, &&op_branch_link, &&op_fusible,
+        &&op_add, &&op_addi, &&op_sub, &&op_subi, &&op_and, &&op_orr
+    };
+    void * dispatchTable[FISC_MAX_INSTRUCTIONS];
+    for (unsigned i = 0; i < FISC_MAX_INSTRUCTIONS; i++)
+        dispatchTable[i] = kindLabels[threadedOpKinds[i]];
+    #define THREADED_DISPATCH() goto *dispatchTable[decodedOp->id]
+#else
+    #define THREADED_DISPATCH() do { \
+        switch (threadedOpKinds[decodedOp->id]) { \
+            case THREADED_OP_BRANCH_LINK: goto op_branch_link; \
+            case THREADED_OP_FUSIBLE:     goto op_fusible;     \
+            case THREADED_OP_ADD:         goto op_add;         \
+            case THREADED_OP_ADDI:        goto op_addi;        \
+            case THREADED_OP_SUB:         goto op_sub;         \
+            case THREADED_OP_SUBI:        goto op_subi;        \
+            case THREADED_OP_AND:         goto op_and;         \
+            case THREADED_OP_ORR:         goto op_orr;         \
+            default:                      goto op_execute;     \
+        } \
+    } while(0)
+#endif
+
+    for (auto & link : ibtc)
+        link.target = nullptr;
+
+block_lookup:
+    /* Interrupts raised by the devices (and the other cores) are taken between blocks (and never chained into) */
+    if (pendingIRQs.load(std::memory_order_relaxed) != 0 && pollInterrupts())
+        previous = nullptr;
+
+    pc_copy = (uint32_t)readRegister(SPECIAL_PC);
+    block = nullptr;
+
+    if (previous != nullptr) {
+        /* Follow the chain (or the IBTC) of the block we just left */
+        decode_block_link_t & link = previous->indirect && blockExit == FISC_BLOCK_EXIT_TAKEN ? ibtc[(pc_copy >> 2) % FISC_IBTC_SIZE] : previous->chain[blockExit];
+
+        if (link.target != nullptr && link.epoch == decodeCacheEpoch && link.targetPC == pc_copy) {
+            block = link.target;
+            /* The successor might have been overwritten since the link was made */
+            if (memory->wasPageWritten(block->page, coreID)) {
+                invalidateDecodePage(block->page);
+                block = nullptr;
+            }
+        }
+        else {
+            epoch = decodeCacheEpoch;
+            block = lookupBlock(pc_copy);
+            /* Only link them if forming the block did not throw the previous one away */
+            if (block != nullptr && epoch == decodeCacheEpoch) {
+                link.targetPC = pc_copy;
+                link.epoch = decodeCacheEpoch;
+                link.target = block;
+            }
+        }
+    }
+
+    if (block == nullptr)
+        block = lookupBlock(pc_copy);
+
+    if (block == nullptr) {
+        /* Nothing we can form a block from. Run a single instruction the slow way */
+        decodedOp = fetch(pc_copy, instruction);
+        if(instruction == (uint32_t)-1 || decodedOp == nullptr) {
+            DEBUG(DERROR, "Unhandled exception: instruction 0x%X (opcode 0x%X, @PC 0x%X) is undefined. Terminating.", instruction, OPCODE_MASK(instruction), pc_copy);
+            enterUndefMode();
+            triggerSoftException(EXC_INVALOPC);
+            return false;
+        }
+        entry = nullptr; /* Nothing gets fused outside of a block */
+        remaining = 1;
+        THREADED_DISPATCH();
+    }
+
+    if (block->aot != nullptr && !cconf->cpsr.pg) {
+        /* Ahead-of-time translated code (which calls back into aotStep() for what it could not translate) */
+        uint32_t executed = 0;
+        epoch = decodeCacheEpoch;
+        uint32_t reason = ((fisc_aot_block_fn_t)block->aot)(this, &aotAPI, &registerBank, &executed);
+        instructionsExecuted += executed;
+
+        if (reason == FISC_AOT_EXIT_HALT) {
+            /* BL 0 halts the CPU */
+            instructionsExecuted++;
+            if ((decodedOp = fetch(cconf->pc, instruction)) != nullptr)
+                timesExecuted[decodedOp->id]++;
+            return true;
+        }
+
+        if (reason == FISC_AOT_EXIT_ERROR) {
+            pc_copy = cconf->pc;
+            instruction = (uint32_t)memory->read(pc_copy, FISC_SZ_32, false, false, ENDIANNESS_TEXTSECT, false);
+            DEBUG(DERROR, "Unhandled exception: execution of instruction 0x%X (opcode 0x%X, @PC 0x%X) failed. Terminating.", instruction, OPCODE_MASK(instruction), pc_copy);
+            enterUndefMode();
+            triggerSoftException(EXC_INVALOPC);
+            return false;
+        }
+
+        /* The block went away if the translated code wrote over its own page */
+        if (epoch != decodeCacheEpoch)
+            block = nullptr;
+        goto block_exit;
+    }
+
+#if FISC_HAS_JIT
+    if (engine == FISC_ENGINE_JIT && !cconf->cpsr.pg) {
+        /* Translated code hardcodes the guest addresses, so it only runs with paging disabled */
+        if (block->native == nullptr && ++block->hotness >= jitThreshold && !jitCompileBlock(block)) {
+            /* The code buffer is full. Throw every translation (and block) away and start over */
+            flushDecodeCache();
+            jitCode.reset();
+            previous = nullptr;
+            if (!jitCode.isAllocated()) {
+                DEBUG(DWARN, "Could not change the protection of the JIT code buffer. Using the threaded engine");
+                engine = FISC_ENGINE_THREADED;
+            }
+            goto block_lookup;
+        }
+
+        if (block->native != nullptr) {
+            uint32_t executed = 0;
+            uint32_t reason = ((jit_block_fn_t)block->native)(this, &executed);
+            instructionsExecuted += executed;
+
+            if (reason == JIT_EXIT_HALT) {
+                /* BL 0 halts the CPU (it's always the last instruction of its block) */
+                instructionsExecuted++;
+                timesExecuted[block->first[block->length - 1].op.id]++;
+                return true;
+            }
+
+            if (reason == JIT_EXIT_ERROR) {
+                pc_copy = cconf->pc;
+                instruction = block->first[(pc_copy - block->address) / (FISC_INSTRUCTION_SZ / 8)].instruction;
+                DEBUG(DERROR, "Unhandled exception: execution of instruction 0x%X (opcode 0x%X, @PC 0x%X) failed. Terminating.", instruction, OPCODE_MASK(instruction), pc_copy);
+                enterUndefMode();
+                triggerSoftException(EXC_INVALOPC);
+                return false;
+            }
+
+            goto block_exit;
+        }
+    }
+#endif
+
+    entry = block->first;
+    remaining = block->length;
+    decodedOp = &entry->op;
+    instruction = entry->instruction;
+    THREADED_DISPATCH();
+
+op_branch_link:
+    if (decodedOp->br_address == 0) {
+        /* BL 0 halts the CPU */
+        instructionsExecuted++;
+        timesExecuted[decodedOp->id]++;
+        return true;
+    }
+    /* Otherwise it's just a regular instruction */
+    goto op_execute;
+
+op_fusible:
+    if (entry != nullptr && entry->fusion != FISC_FUSION_NONE) {
+        /* The first instruction of a fused group (see fuseBlock()). Run all of it, then carry on from its last instruction */
+        ret = executeFused(entry, pc_copy);
+        instructionsExecuted += entry->fusedLength;
+        for (unsigned i = 0; i < entry->fusedLength; i++)
+            timesExecuted[entry[i].op.id]++;
+
+        unsigned skipped = entry->fusedLength - 1;
+        pc_copy += skipped * (FISC_INSTRUCTION_SZ / 8);
+        remaining -= skipped;
+        entry += skipped;
+        decodedOp = &entry->op;
+        instruction = entry->instruction;
+        goto op_retire;
+    }
+    /* Otherwise it's just a regular instruction */
+    goto op_execute;
+
+    /* The inlined bodies. Same semantics as their handlers (XZR is never written and always reads as zero) */
+op_add:
+    if (decodedOp->rd != XZR)
+        *registerBank[decodedOp->rd] = *registerBank[decodedOp->rn] + *registerBank[decodedOp->rm];
+    goto op_inlined;
+
+op_addi:
+    if (decodedOp->rd != XZR) {
+        int64_t aluimm = decodedOp->alu_immediate;
+        if (aluimm & (1 << (12 - 1))) aluimm = -((~aluimm + 1) & 0xFFF); /* Fix non 64-bit number signedness */
+        *registerBank[decodedOp->rd] = *registerBank[decodedOp->rn] + aluimm;
+    }
+    goto op_inlined;
+
+op_sub:
+    if (decodedOp->rd != XZR)
+        *registerBank[decodedOp->rd] = *registerBank[decodedOp->rn] - *registerBank[decodedOp->rm];
+    goto op_inlined;
+
+op_subi:
+    if (decodedOp->rd != XZR) {
+        int64_t aluimm = decodedOp->alu_immediate;
+        if (aluimm & (1 << (12 - 1))) aluimm = -((~aluimm + 1) & 0xFFF); /* Fix non 64-bit number signedness */
+        *registerBank[decodedOp->rd] = *registerBank[decodedOp->rn] - aluimm;
+    }
+    goto op_inlined;
+
+op_and:
+    if (decodedOp->rd != XZR)
+        *registerBank[decodedOp->rd] = *registerBank[decodedOp->rn] & *registerBank[decodedOp->rm];
+    goto op_inlined;
+
+op_orr:
+    if (decodedOp->rd != XZR)
+        *registerBank[decodedOp->rd] = *registerBank[decodedOp->rn] | *registerBank[decodedOp->rm];
+
+op_inlined:
+    ret = FISC_RET_OK;
+    instructionsExecuted++;
+    timesExecuted[decodedOp->id]++;
+    goto op_retire;
+
+op_execute:
+    /* Stages 3, 4 and 5 - Execute instruction, Access Memory and Write back to the registers */
+    ret = decodedOp->handler(decodedOp, this);
+    instructionsExecuted++;
+    timesExecuted[decodedOp->id]++;
+
+op_retire:
+    if (ret == FISC_RET_ERROR) {
+        DEBUG(DERROR, "Unhandled exception: execution of instruction 0x%X (opcode 0x%X, @PC 0x%X) failed. Terminating.", instruction, OPCODE_MASK(instruction), pc_copy);
+        enterUndefMode();
+        triggerSoftException(EXC_INVALOPC);
+        return false;
+    }
+
+    /* A taken branch, an exception or an interrupt ends the block right here */
+    if (isBranching || generatedException || generatedExternalException || generatedExternalInterrupt || generatedInterrupt)
+        goto block_exit;
+
+    writeRegister(SPECIAL_PC, (pc_copy += FISC_INSTRUCTION_SZ / 8), false, 0, 0, 0);
+
+    if (--remaining == 0)
+        goto block_exit;
+
+    if (memory->wasPageWritten(block->page, coreID)) {
+        /* Self modifying code. The rest of this block is stale */
+        invalidateDecodePage(block->page);
+        previous = nullptr;
+        goto block_lookup;
+    }
+
+    entry++;
+    decodedOp = &entry->op;
+    instruction = entry->instruction;
+    THREADED_DISPATCH();
+
+block_exit:
+    /* Exceptions and interrupts never get chained. Neither does anything while paging is
+       enabled, as the page tables might map the same virtual address somewhere else */
+    if (block != nullptr && !cconf->cpsr.pg && !generatedException && !generatedExternalException && !generatedExternalInterrupt && !generatedInterrupt) {
+        previous = block;
+        blockExit = isBranching ? FISC_BLOCK_EXIT_TAKEN : FISC_BLOCK_EXIT_FALLTHROUGH;
+    }
+    else {
+        previous = nullptr;
+    }
+
+    isBranching = false;
+    generatedException = false;
+    generatedInterrupt = false;
+    generatedExternalInterrupt = false;
+    goto block_lookup;
+
+    #undef THREADED_DISPATCH
+}
+
+bool CPUModule::runCore(uint32_t & instructionsExecuted)
+{
+    /* Pick the instantiations for the features this core starts with */
+    updateFeatures();
+
+    /* The threaded engine does not trace, so tracing always goes through the reference loop */
+    if ((engine == FISC_ENGINE_THREADED || engine == FISC_ENGINE_JIT) && !memory->showExecution)
+        return runThreaded(instructionsExecuted);
+    return runReference(instructionsExecuted);
+}
+
+enum PassRetcode CPUModule::run()
+{
+    DEBUG(DGOOD," -- EXECUTING CPU (mode: %s) --%s", getCurrentCPUModeStr().c_str(), memory->showExecution ? "\n" : "");
+    
+    /* 
+    -- CPU ALGORITHM --
+        1-Fetch
+        2-Decode
+        3-Execute
+        4-Memory Access
+        5-Writeback
+
+        * Repeat *
+    */
+
+    bool successfulExecution = false;
+    uint32_t instructionsExecuted = 1;
+
+    /* Every core runs on its own thread. This one is the boot core's */
+    startSecondaryCores();
+    successfulExecution = runCore(instructionsExecuted);
+    joinSecondaryCores();
+
+    if (!tcacheDir.empty())
+        saveTranslationCache();
 
     /* Wait for stdout / in to be flushed */
     VMConsole * vmConsole = dynamic_cast<VMConsole*>(ioconf->getDevice("VMConsole"));
@@ -0,0 +1,36 @@
+#ifndef FISCCPUTLB_H_
+#define FISCCPUTLB_H_
+
+#include <stdint.h>
+
+namespace FISC {
+
+/***************************************/
+/* Translation lookaside buffer layout */
+/***************************************/
+
+#define FISC_TLB_ENTRIES 64          /* How many entries each side of the TLB has (direct mapped by virtual page) */
+#define FISC_TLB_INVALID 0xFFFFFFFFu /* The tag of an empty entry (no virtual page number is ever this large)   */
+
+/* The TLB keeps instruction fetches and data accesses apart, so
+   that code and data never evict each other's translations */
+enum FISC_TLB_SIDE {
+    FISC_TLB_INSTRUCTION,
+    FISC_TLB_DATA,
+    FISC_TLB_SIDES
+};
+
+/* Permission bits of an entry (both the page table entry and the page must allow it) */
+#define FISC_TLB_PERM_USER  1 /* Accessible from user mode */
+#define FISC_TLB_PERM_WRITE 2 /* Writable                  */
+
+/* One cached page walk. Only successful walks are ever cached */
+typedef struct {
+    uint32_t virtualPage;  /* The tag (FISC_TLB_INVALID if the entry is empty) */
+    uint32_t physicalPage; /* The page frame it maps to                        */
+    uint8_t  permissions;  /* FISC_TLB_PERM_*                                  */
+} tlb_entry_t;
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef FISCCPUTRANSLATIONCACHE_H_
+#define FISCCPUTRANSLATIONCACHE_H_
+
+#include "ISA/FISCISA.h"
+#include <fvm/Utils/Hash.h>
+
+namespace FISC {
+
+/*************************************************/
+/* Persistent (on disk) translation cache layout */
+/*************************************************/
+
+/* The file is a tcache_header_t, followed by 'instructionCount' tcache_instruction_t
+   records and then by 'blockCount' tcache_block_t records. It's only ever read back by
+   the same build of the VM, so everything is stored in the host's native byte order */
+
+#define FISC_TCACHE_MAGIC     "FISCTC01"
+#define FISC_TCACHE_EXTENSION ".tcache"
+
+typedef struct {
+    char     magic[8];         /* FISC_TCACHE_MAGIC                                      */
+    uint64_t programHash;      /* The hash of the program image the cache was made from  */
+    uint64_t buildID;          /* The build of the VM that made the cache                */
+    uint32_t instructionCount; /* How many tcache_instruction_t records follow            */
+    uint32_t blockCount;       /* How many tcache_block_t records follow the instructions */
+} tcache_header_t;
+
+/* One predecoded instruction (a decoded_op_t without its handler, which is rebound through 'id') */
+typedef struct {
+    uint32_t address;     /* The guest physical address of the instruction */
+    uint32_t instruction; /* The raw instruction word                      */
+    uint32_t imm;
+    uint8_t  rd, rn, rm, id;
+} tcache_instruction_t;
+
+/* One basic block and how hot it was when the cache was saved */
+typedef struct {
+    uint32_t address; /* The guest physical address of the first instruction of the block */
+    uint32_t hotness;
+} tcache_block_t;
+
+/* Identifies the build of the VM. Instruction ids and decoded_op_t layouts are only meaningful to the build that made them */
+static inline uint64_t tcacheBuildID(uint32_t instructionCount)
+{
+    static const char buildStamp[] = __DATE__ " " __TIME__;
+    uint64_t hash = fnv1a64(buildStamp, sizeof(buildStamp) - 1);
+    hash = fnv1a64(&instructionCount, sizeof(instructionCount), hash);
+    uint32_t opSize = sizeof(decoded_op_t);
+    return fnv1a64(&opSize, sizeof(opSize), hash);
+}
+
+}
+
+#endif
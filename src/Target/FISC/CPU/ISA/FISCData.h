@@ -12,22 +12,22 @@
 /**************************************************************/
 NEW_INSTRUCTION(FISC, MOVZ, IWF, /* Operation: R[Rt](quadrant) = MOVImm (Clears register first) */
 {
-    switch (_this_->ifmt_iw->quadrant) {
+    switch (_this_->quadrant) {
     case 0:
-        return _cpu_->writeRegister(_this_->ifmt_iw->rt, 
-                                    _this_->ifmt_iw->mov_immediate & 0xFFFF, 
+        return _cpu_->writeRegister(_this_->rt, 
+                                    _this_->mov_immediate & 0xFFFF, 
                                     false, 0,0,0);
     case 1:
-        return _cpu_->writeRegister(_this_->ifmt_iw->rt, 
-                                   (uint64_t)(_this_->ifmt_iw->mov_immediate & 0xFFFF) << 16, 
+        return _cpu_->writeRegister(_this_->rt, 
+                                   (uint64_t)(_this_->mov_immediate & 0xFFFF) << 16, 
                                     false, 0,0,0);
     case 2:
-        return _cpu_->writeRegister(_this_->ifmt_iw->rt,
-                                   (uint64_t)(_this_->ifmt_iw->mov_immediate & 0xFFFF) << 32,
+        return _cpu_->writeRegister(_this_->rt,
+                                   (uint64_t)(_this_->mov_immediate & 0xFFFF) << 32,
                                     false, 0, 0, 0);
     case 3:
-        return _cpu_->writeRegister(_this_->ifmt_iw->rt, 
-                                   (uint64_t)(_this_->ifmt_iw->mov_immediate & 0xFFFF) << 48, 
+        return _cpu_->writeRegister(_this_->rt, 
+                                   (uint64_t)(_this_->mov_immediate & 0xFFFF) << 48, 
                                     false, 0,0,0);
     }
     return FISC_RET_ERROR;
@@ -35,53 +35,53 @@ NEW_INSTRUCTION(FISC, MOVZ, IWF, /* Operation: R[Rt](quadrant) = MOVImm (Clears
 
 NEW_INSTRUCTION(FISC, MOVK, IWF, /* Operation: R[Rt](quadrant) = MOVImm */
 {
-    uint64_t dstRegVal = _cpu_->readRegister(_this_->ifmt_iw->rt);
+    uint64_t dstRegVal = _cpu_->readRegister(_this_->rt);
 
-    switch (_this_->ifmt_iw->quadrant) {
+    switch (_this_->quadrant) {
         case 0:
             dstRegVal &= 0xFFFFFFFFFFFF0000;
-            dstRegVal |= _this_->ifmt_iw->mov_immediate & 0xFFFF;
+            dstRegVal |= _this_->mov_immediate & 0xFFFF;
             break;
         case 1:
             dstRegVal &= 0xFFFFFFFF0000FFFF;
-            dstRegVal |= (_this_->ifmt_iw->mov_immediate & 0xFFFF) << 16;
+            dstRegVal |= (_this_->mov_immediate & 0xFFFF) << 16;
             break;
         case 2:
             dstRegVal &= 0xFFFF0000FFFFFFFF;
-            dstRegVal |= (uint64_t)((_this_->ifmt_iw->mov_immediate & 0xFFFF)) << 32;
+            dstRegVal |= (uint64_t)((_this_->mov_immediate & 0xFFFF)) << 32;
             break;
         case 3:
             dstRegVal &= 0x0000FFFFFFFFFFFF;
-            dstRegVal |= (uint64_t)((_this_->ifmt_iw->mov_immediate & 0xFFFF)) << 48;
+            dstRegVal |= (uint64_t)((_this_->mov_immediate & 0xFFFF)) << 48;
             break;
         default: return FISC_RET_ERROR;
     }
 
-    return _cpu_->writeRegister(_this_->ifmt_iw->rt, dstRegVal, false, 0, 0, 0);
+    return _cpu_->writeRegister(_this_->rt, dstRegVal, false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, MOVRZ, IWF, /* Operation: R[Rt](quadrant) = PC + MOVImm (Clears register first) */
 {
     uint64_t pcVal = _cpu_->readRegister(SPECIAL_PC);
 
-    int32_t movimm = (int32_t)_this_->ifmt_iw->mov_immediate;
+    int32_t movimm = (int32_t)_this_->mov_immediate;
     if (movimm & (1 << (16 - 1))) movimm = -((~movimm + 1) & 0xFFFF); /* Fix non 64-bit number signedness */
     
-    switch (_this_->ifmt_iw->quadrant) {
+    switch (_this_->quadrant) {
     case 0:
-        return _cpu_->writeRegister(_this_->ifmt_iw->rt, 
+        return _cpu_->writeRegister(_this_->rt, 
                                     (pcVal & 0xFFFF) + movimm,
                                     false, 0,0,0);
     case 1:
-        return _cpu_->writeRegister(_this_->ifmt_iw->rt, 
+        return _cpu_->writeRegister(_this_->rt, 
                                     ((pcVal & 0xFFFF) << 16) + ((uint64_t)(movimm) << 16),
                                     false, 0,0,0);
     case 2:
-        return _cpu_->writeRegister(_this_->ifmt_iw->rt,
+        return _cpu_->writeRegister(_this_->rt,
                                     ((uint64_t)(movimm) << 32),
                                     false, 0, 0, 0);
     case 3:
-        return _cpu_->writeRegister(_this_->ifmt_iw->rt, 
+        return _cpu_->writeRegister(_this_->rt, 
                                     ((uint64_t)(movimm) << 48),
                                     false, 0,0,0);
     }
@@ -90,13 +90,13 @@ NEW_INSTRUCTION(FISC, MOVRZ, IWF, /* Operation: R[Rt](quadrant) = PC + MOVImm (C
 
 NEW_INSTRUCTION(FISC, MOVRK, IWF, /* Operation: R[Rt](quadrant) = PC + MOVImm */
 {
-    uint64_t dstRegVal = _cpu_->readRegister(_this_->ifmt_iw->rt);
+    uint64_t dstRegVal = _cpu_->readRegister(_this_->rt);
     uint64_t pcVal = _cpu_->readRegister(SPECIAL_PC);
 
-    int32_t movimm = (int32_t)_this_->ifmt_iw->mov_immediate;
+    int32_t movimm = (int32_t)_this_->mov_immediate;
     if (movimm & (1 << (16 - 1))) movimm = -((~movimm + 1) & 0xFFFF); /* Fix non 64-bit number signedness */
 
-    switch (_this_->ifmt_iw->quadrant) {
+    switch (_this_->quadrant) {
         case 0:
             dstRegVal &= 0xFFFFFFFFFFFF0000;
             dstRegVal |= (pcVal & 0xFFFF) + movimm;
@@ -116,7 +116,7 @@ NEW_INSTRUCTION(FISC, MOVRK, IWF, /* Operation: R[Rt](quadrant) = PC + MOVImm */
         default: return FISC_RET_ERROR;
     }
 
-    return _cpu_->writeRegister(_this_->ifmt_iw->rt, dstRegVal, false, 0, 0, 0);
+    return _cpu_->writeRegister(_this_->rt, dstRegVal, false, 0, 0, 0);
 });
 
 /**************************************************************/
@@ -132,219 +132,217 @@ NEW_INSTRUCTION(FISC, LDPC, RF, /* Operation: R[LR] = PC */
 /**************************************************************/
 NEW_INSTRUCTION(FISC, LDR, DF, /* Operation: R[Rt] = M[R[Rn] + DTAddr] (64 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
 
     /* Read memory contents (M[R[Rn] + DTAddr]) */
-    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
+    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
 
     /* Load those contents into the register (R[Rt] = MemVal) */
-    return _cpu_->writeRegister(_this_->ifmt_d->rt, memVal, false, 0, 0, 0);
+    return _cpu_->writeRegister(_this_->rt, memVal, false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, LDRB, DF, /* Operation: R[Rt] = M[R[Rn] + DTAddr] (8 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
 
     /* Read memory contents (M[R[Rn] + DTAddr]) */
-    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
+    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
 
     /* Load those contents into the register (R[Rt] = MemVal) */
-    return _cpu_->writeRegister(_this_->ifmt_d->rt, memVal, false, 0, 0, 0);
+    return _cpu_->writeRegister(_this_->rt, memVal, false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, LDRH, DF, /* Operation: R[Rt] = M[R[Rn] + DTAddr] (16 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
 
     /* Read memory contents (M[R[Rn] + DTAddr]) */
-    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
+    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
 
     /* Load those contents into the register (R[Rt] = MemVal) */
-    return _cpu_->writeRegister(_this_->ifmt_d->rt, memVal, false, 0, 0, 0);
+    return _cpu_->writeRegister(_this_->rt, memVal, false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, LDRSW, DF, /* Operation: R[Rt] = M[R[Rn] + DTAddr] (32 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
 
     /* Read memory contents (M[R[Rn] + DTAddr]) */
-    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
+    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
 
     /* Load those contents into the register (R[Rt] = MemVal) */
-    return _cpu_->writeRegister(_this_->ifmt_d->rt, memVal, false, 0, 0, 0);
+    return _cpu_->writeRegister(_this_->rt, memVal, false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, LDXR, DF, /* Operation: R[Rt] = M[R[Rn] + DTAddr] (64 bits wide) */
 {
-    /* TODO: ATOMIC */
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
 
-    /* Read memory contents (M[R[Rn] + DTAddr]) */
-    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
+    /* Read memory contents (M[R[Rn] + DTAddr]) and arm the exclusive monitor */
+    uint64_t memVal = _cpu_->mmu_read_exclusive((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
 
     /* Load those contents into the register (R[Rt] = MemVal) */
-    return _cpu_->writeRegister(_this_->ifmt_d->rt, memVal, false, 0, 0, 0);
+    return _cpu_->writeRegister(_this_->rt, memVal, false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, LDRR, DF, /* Operation: R[Rt] = M[PC + R[Rn] + DTAddr] (64 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
     
     /* Add the PC value into the offset */
     offset += _cpu_->readRegister(SPECIAL_PC);
 
     /* Read memory contents (M[PC + R[Rn] + DTAddr]) */
-    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
+    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
 
     /* Load those contents into the register (R[Rt] = MemVal) */
-    return _cpu_->writeRegister(_this_->ifmt_d->rt, memVal, false, 0, 0, 0);
+    return _cpu_->writeRegister(_this_->rt, memVal, false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, LDRBR, DF, /* Operation: R[Rt] = M[PC + R[Rn] + DTAddr] (8 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
     
     /* Add the PC value into the offset */
     offset += _cpu_->readRegister(SPECIAL_PC);
 
     /* Read memory contents (M[PC + R[Rn] + DTAddr]) */
-    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
+    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
 
     /* Load those contents into the register (R[Rt] = MemVal) */
-    return _cpu_->writeRegister(_this_->ifmt_d->rt, memVal, false, 0, 0, 0);
+    return _cpu_->writeRegister(_this_->rt, memVal, false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, LDRHR, DF, /* Operation: R[Rt] = M[PC + R[Rn] + DTAddr] (16 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
     
     /* Add the PC value into the offset */
     offset += _cpu_->readRegister(SPECIAL_PC);
 
     /* Read memory contents (M[PC + R[Rn] + DTAddr]) */
-    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
+    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
 
     /* Load those contents into the register (R[Rt] = MemVal) */
-    return _cpu_->writeRegister(_this_->ifmt_d->rt, memVal, false, 0, 0, 0);
+    return _cpu_->writeRegister(_this_->rt, memVal, false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, LDRSWR, DF, /* Operation: R[Rt] = M[PC + R[Rn] + DTAddr] (32 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
     
     /* Add the PC value into the offset */
     offset += _cpu_->readRegister(SPECIAL_PC);
 
     /* Read memory contents (M[PC + R[Rn] + DTAddr]) */
-    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
+    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
 
     /* Load those contents into the register (R[Rt] = MemVal) */
-    return _cpu_->writeRegister(_this_->ifmt_d->rt, memVal, false, 0, 0, 0);
+    return _cpu_->writeRegister(_this_->rt, memVal, false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, LDXRR, DF, /* Operation: R[Rt] = M[PC + R[Rn] + DTAddr] (64 bits wide) */
 {
-    /* TODO: ATOMIC */
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
     
     /* Add the PC value into the offset */
     offset += _cpu_->readRegister(SPECIAL_PC);
 
-    /* Read memory contents (M[PC + R[Rn] + DTAddr]) */
-    uint64_t memVal = _cpu_->mmu_read((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
+    /* Read memory contents (M[PC + R[Rn] + DTAddr]) and arm the exclusive monitor */
+    uint64_t memVal = _cpu_->mmu_read_exclusive((uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, ENDIANNESS_DATASECT, ENABLE_LOAD_MEMORYACCESS_DEBUGGING);
 
     /* Load those contents into the register (R[Rt] = MemVal) */
-    return _cpu_->writeRegister(_this_->ifmt_d->rt, memVal, false, 0, 0, 0);
+    return _cpu_->writeRegister(_this_->rt, memVal, false, 0, 0, 0);
 });
 
 /**************************************************************/
@@ -352,219 +350,262 @@ NEW_INSTRUCTION(FISC, LDXRR, DF, /* Operation: R[Rt] = M[PC + R[Rn] + DTAddr] (6
 /**************************************************************/
 NEW_INSTRUCTION(FISC, STR_, DF, /* Operation: M[R[Rn] + DTAddr] = R[Rt] (64 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
     
     /* Read register value (R[Rt]) */
-    uint64_t regVal = _cpu_->readRegister(_this_->ifmt_d->rt);
+    uint64_t regVal = _cpu_->readRegister(_this_->rt);
 
     /* Write register value into the memory (M[R[Rn] + DTAddr] = R[Rt]) */
-    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
 });
 
 NEW_INSTRUCTION(FISC, STRB, DF, /* Operation: M[R[Rn] + DTAddr] = R[Rt] (8 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
     
     /* Read register value (R[Rt]) */
-    uint64_t regVal = _cpu_->readRegister(_this_->ifmt_d->rt);
+    uint64_t regVal = _cpu_->readRegister(_this_->rt);
 
     /* Write register value into the memory (M[R[Rn] + DTAddr] = R[Rt]) */
-    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
 });
 
 NEW_INSTRUCTION(FISC, STRH, DF, /* Operation: M[R[Rn] + DTAddr] = R[Rt] (16 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
     
     /* Read register value (R[Rt]) */
-    uint64_t regVal = _cpu_->readRegister(_this_->ifmt_d->rt);
+    uint64_t regVal = _cpu_->readRegister(_this_->rt);
 
     /* Write register value into the memory (M[R[Rn] + DTAddr] = R[Rt]) */
-    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
 });
 
 NEW_INSTRUCTION(FISC, STRW, DF, /* Operation: M[R[Rn] + DTAddr] = R[Rt] (32 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
     
     /* Read register value (R[Rt]) */
-    uint64_t regVal = _cpu_->readRegister(_this_->ifmt_d->rt);
+    uint64_t regVal = _cpu_->readRegister(_this_->rt);
 
     /* Write register value into the memory (M[R[Rn] + DTAddr] = R[Rt]) */
-    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
 });
 
-NEW_INSTRUCTION(FISC, STXR, DF, /* Operation: M[R[Rn] + DTAddr] = R[Rt] (64 bits wide) */
+NEW_INSTRUCTION(FISC, STXR, DF, /* Operation: if exclusive(R[Rn] + DTAddr) { M[R[Rn] + DTAddr] = R[Rt]; Z = 1 } else Z = 0 (64 bits wide) */
 {
-    /* TODO: ATOMIC */
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
     
     /* Read register value (R[Rt]) */
-    uint64_t regVal = _cpu_->readRegister(_this_->ifmt_d->rt);
+    uint64_t regVal = _cpu_->readRegister(_this_->rt);
 
-    /* Write register value into the memory (M[R[Rn] + DTAddr] = R[Rt]) */
-    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    /* Write register value into the memory (M[R[Rn] + DTAddr] = R[Rt]) if the exclusive monitor allows it. Z = success */
+    return _cpu_->mmu_write_exclusive(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
 });
 
 NEW_INSTRUCTION(FISC, STRR, DF, /* Operation: M[PC + R[Rn] + DTAddr] = R[Rt] (64 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
 
     /* Add the PC value into the offset */
     offset += _cpu_->readRegister(SPECIAL_PC);
     
     /* Read register value (R[Rt]) */
-    uint64_t regVal = _cpu_->readRegister(_this_->ifmt_d->rt);
+    uint64_t regVal = _cpu_->readRegister(_this_->rt);
 
     /* Write register value into the memory (M[R[Rn] + DTAddr] = R[Rt]) */
-    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
 });
 
 NEW_INSTRUCTION(FISC, STRBR, DF,  /* Operation: M[PC + R[Rn] + DTAddr] = R[Rt] (8 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
 
     /* Add the PC value into the offset */
     offset += _cpu_->readRegister(SPECIAL_PC);
     
     /* Read register value (R[Rt]) */
-    uint64_t regVal = _cpu_->readRegister(_this_->ifmt_d->rt);
+    uint64_t regVal = _cpu_->readRegister(_this_->rt);
 
     /* Write register value into the memory (M[R[Rn] + DTAddr] = R[Rt]) */
-    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
 });
 
 NEW_INSTRUCTION(FISC, STRHR, DF,  /* Operation: M[PC + R[Rn] + DTAddr] = R[Rt] (16 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
 
     /* Add the PC value into the offset */
     offset += _cpu_->readRegister(SPECIAL_PC);
     
     /* Read register value (R[Rt]) */
-    uint64_t regVal = _cpu_->readRegister(_this_->ifmt_d->rt);
+    uint64_t regVal = _cpu_->readRegister(_this_->rt);
 
     /* Write register value into the memory (M[R[Rn] + DTAddr] = R[Rt]) */
-    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
 });
 
 NEW_INSTRUCTION(FISC, STRWR, DF,  /* Operation: M[PC + R[Rn] + DTAddr] = R[Rt] (32 bits wide) */
 {
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
 
     /* Add the PC value into the offset */
     offset += _cpu_->readRegister(SPECIAL_PC);
     
     /* Read register value (R[Rt]) */
-    uint64_t regVal = _cpu_->readRegister(_this_->ifmt_d->rt);
+    uint64_t regVal = _cpu_->readRegister(_this_->rt);
 
     /* Write register value into the memory (M[R[Rn] + DTAddr] = R[Rt]) */
-    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
 });
 
-NEW_INSTRUCTION(FISC, STXRR, DF, /* Operation: M[PC + R[Rn] + DTAddr] = R[Rt] (64 bits wide) */
+NEW_INSTRUCTION(FISC, STXRR, DF, /* Operation: if exclusive(PC + R[Rn] + DTAddr) { M[PC + R[Rn] + DTAddr] = R[Rt]; Z = 1 } else Z = 0 (64 bits wide) */
 {
-    /* TODO: ATOMIC */
-    uint64_t base = _cpu_->readRegister(_this_->ifmt_d->rn);
-    int64_t offset = _this_->ifmt_d->dt_address;
+    uint64_t base = _cpu_->readRegister(_this_->rn);
+    int64_t offset = _this_->dt_address;
     if(offset & (1<<(9-1))) offset = -((~offset + 1) & 0x1FF); /* Fix non 64-bit number signedness */
     
     /* Align (or not) the base and unscaled offset */
-    uint64_t cpsrVal = _cpu_->readRegister(SPECIAL_CPSR);
-    if(((cpsr_t*)&cpsrVal)->ae & 1)
-        base = ALIGN_BASE(base, _this_->ifmt_d->op);
-    if(((cpsr_t*)&cpsrVal)->ae & 2)
-        offset = ALIGN_DTADDR(offset, _this_->ifmt_d->op);
+    unsigned alignEnable = _cpu_->getAlignmentEnable();
+    if(alignEnable & 1)
+        base = ALIGN_BASE(base, _this_->op);
+    if(alignEnable & 2)
+        offset = ALIGN_DTADDR(offset, _this_->op);
 
     /* Add the PC value into the offset */
     offset += _cpu_->readRegister(SPECIAL_PC);
     
     /* Read register value (R[Rt]) */
-    uint64_t regVal = _cpu_->readRegister(_this_->ifmt_d->rt);
+    uint64_t regVal = _cpu_->readRegister(_this_->rt);
 
-    /* Write register value into the memory (M[R[Rn] + DTAddr] = R[Rt]) */
-    return _cpu_->mmu_write(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->ifmt_d->op, false, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    /* Write register value into the memory (M[R[Rn] + DTAddr] = R[Rt]) if the exclusive monitor allows it. Z = success */
+    return _cpu_->mmu_write_exclusive(regVal, (uint32_t)(base + offset), (enum FISC_DATATYPE)_this_->op, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+});
+
+/**************************************************************/
+/************ ATOMIC READ-MODIFY-WRITE INSTRUCTIONS ***********/
+/**************************************************************/
+NEW_INSTRUCTION(FISC, CAS, RF, /* Operation: R[Rd] = M[R[Rn]], M[R[Rn]] = R[Rm] if it held R[Rd] (64 bits wide, atomically) */
+{
+    /* The expected value goes in through oldValue, and what the memory held comes out of it */
+    uint64_t oldValue = _cpu_->readRegister(_this_->rd);
+    enum FISC_RETTYPE ret = _cpu_->mmu_atomic(FISC_ATOMIC_CAS, (uint32_t)_cpu_->readRegister(_this_->rn), FISC_SZ_64, _cpu_->readRegister(_this_->rm), oldValue, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    if (ret != FISC_RET_OK)
+        return ret;
+    return _cpu_->writeRegister(_this_->rd, oldValue, false, 0, 0, 0);
+});
+
+NEW_INSTRUCTION(FISC, LDADD, RF, /* Operation: R[Rd] = M[R[Rn]], M[R[Rn]] = M[R[Rn]] + R[Rm] (64 bits wide, atomically) */
+{
+    uint64_t oldValue = 0;
+    enum FISC_RETTYPE ret = _cpu_->mmu_atomic(FISC_ATOMIC_ADD, (uint32_t)_cpu_->readRegister(_this_->rn), FISC_SZ_64, _cpu_->readRegister(_this_->rm), oldValue, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    if (ret != FISC_RET_OK)
+        return ret;
+    return _cpu_->writeRegister(_this_->rd, oldValue, false, 0, 0, 0);
+});
+
+NEW_INSTRUCTION(FISC, SWP, RF, /* Operation: R[Rd] = M[R[Rn]], M[R[Rn]] = R[Rm] (64 bits wide, atomically) */
+{
+    uint64_t oldValue = 0;
+    enum FISC_RETTYPE ret = _cpu_->mmu_atomic(FISC_ATOMIC_SWAP, (uint32_t)_cpu_->readRegister(_this_->rn), FISC_SZ_64, _cpu_->readRegister(_this_->rm), oldValue, ENDIANNESS_DATASECT, ENABLE_STORE_MEMORYACCESS_DEBUGGING);
+    if (ret != FISC_RET_OK)
+        return ret;
+    return _cpu_->writeRegister(_this_->rd, oldValue, false, 0, 0, 0);
+});
+
+/* The memory barriers. Plain loads and stores don't get reordered by this core, but the
+   other cores may see them in any order unless the guest puts one of these in between */
+NEW_INSTRUCTION(FISC, DMBA, RF, /* Operation: No later load / store happens before the earlier loads (acquire) */
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return FISC_RET_OK;
+});
+
+NEW_INSTRUCTION(FISC, DMBR, RF, /* Operation: No earlier load / store happens after the later stores (release) */
+{
+    std::atomic_thread_fence(std::memory_order_release);
+    return FISC_RET_OK;
 });
 
 #endif
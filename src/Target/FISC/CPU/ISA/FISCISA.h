@@ -2,7 +2,6 @@
 #define FISCISA_H_
 
 #include <string>
-#include <functional>
 #include <stdint.h>
 #include <stdarg.h>
 #include <fvm/Utils/Bit.h>
@@ -17,13 +16,15 @@ namespace FISC {
 
 #define FISC_INSTRUCTION_SZ         32     /* How wide is the instruction (in bits, not bytes)                                   */
 #define FISC_REGISTER_COUNT         32     /* How many registers will we use                                                     */
-#define FISC_SPECIAL_REGISTER_COUNT 14     /* How many special registers will we use                                             */
+#define FISC_SPECIAL_REGISTER_COUNT 15     /* How many special registers will we use                                             */
 #define FISC_TOTAL_REGISTER_COUNT (FISC_REGISTER_COUNT + FISC_SPECIAL_REGISTER_COUNT) /* How many registers in total             */
 #define FISC_DEFAULT_EXEC_MODE      FISC_CPU_MODE_KERNEL /* The default mode of execution of the CPU                             */
 #define FISC_PAGES_PER_TABLE        1024   /* How many pages are present on an MMU's Table entry                                 */
 #define FISC_TABLES_PER_DIR         1024   /* How many tables can a Page directory hold                                          */
 #define FISC_PAGE_SIZE              0x1000 /* How large of a block each Page entry can represent                                 */
 #define FISC_USER_SYSCALL_CODE      0xFFF  /* The interrupt number the user must use when executing system calls (or interrupts) */
+#define FISC_MAX_CORES              32     /* How many CPU cores a machine can have                                              */
+#define FISC_IRQ_LINES              64     /* Hardware (and inter-processor) interrupts can carry the interrupt codes 0 .. 63    */
 
 #define ENDIANNESS_TEXTSECT false /* 0: big endian 1: little endian */
 #define ENDIANNESS_DATASECT true  /* 0: big endian 1: little endian */
@@ -45,59 +46,35 @@ enum INSTRUCTION_FMT {
 #define IWF IFMT_IW
 
 #define OPCODE_MASK(instr) (((instr) & 0xFFE00000) >> 21)
+#define FISC_OPCODE_SZ       11                       /* The widest opcode (in bits). Narrower opcodes have don't care bits to the right */
+#define FISC_OPCODE_TABLE_SZ (1 << FISC_OPCODE_SZ)    /* How many entries the flat opcode table has                                     */
+
+/* Instruction formats (fields listed from bit 0 upwards):
+   R:  Rd (5) | Rn (5) | Shamt (6)           | Rm (5)       | Opcode (11)
+   I:  Rd (5) | Rn (5) | ALUImm (12)         | Opcode (10, the lowest bit is a don't care)
+   D:  Rt (5) | Rn (5) | Op (2) | DTAddr (9) | Opcode (11)
+   B:  BrAddr (26)                           | Opcode (6, the lowest 5 bits are don't cares)
+   CB: Rt (5) | CondBrAddr (19)              | Opcode (8, the lowest 3 bits are don't cares)
+   IW: Rt (5) | MOVImm (16) | Quadrant (2)   | Opcode (9)
+   The fields are taken out with shifts and masks (instead of bitfields), which fold away at compile time */
+constexpr uint32_t instrField(uint32_t instruction, unsigned lsb, unsigned width)
+{
+	return (instruction >> lsb) & ((1u << width) - 1);
+}
 
-typedef struct ifmt_r {
-	unsigned rd     : 5;
-	unsigned rn     : 5;
-	unsigned shamt  : 6;
-	unsigned rm     : 5;
-	unsigned opcode : 11;
-} ifmt_r_t;
-
-#define INSTR_TO_IFMT_R(instruction) ((ifmt_r_t*)&instruction)
-
-typedef struct ifmt_i {
-	unsigned rd            : 5;
-	unsigned rn            : 5;
-	unsigned alu_immediate : 12;
-	unsigned opcode        : 10; /* The lower 1 bit is discarded, it's like an X (don't care) */
-} ifmt_i_t;
-
-#define INSTR_TO_IFMT_I(instruction) ((ifmt_i_t*)&instruction)
-
-typedef struct ifmt_d {
-	unsigned rt         : 5;
-	unsigned rn         : 5;
-	unsigned op         : 2;
-	unsigned dt_address : 9;
-	unsigned opcode     : 11;
-} ifmt_d_t;
-
-#define INSTR_TO_IFMT_D(instruction) ((ifmt_d_t*)&instruction)
-
-typedef struct ifmt_b {
-	unsigned br_address : 26;
-	unsigned opcode     : 6; /* The lower 5 bits are discarded, they are like X's (don't cares) */
-} ifmt_b_t;
-
-#define INSTR_TO_IFMT_B(instruction) ((ifmt_b_t*)&instruction)
-
-typedef struct ifmt_cb {
-	unsigned rt              : 5;
-	unsigned cond_br_address : 19;
-	unsigned opcode          : 8; /* The lower 3 bits are discarded, they are like X's (don't cares) */
-} ifmt_cb_t;
-
-#define INSTR_TO_IFMT_CB(instruction) ((ifmt_cb_t*)&instruction)
-
-typedef struct ifmt_iw {
-	unsigned rt            : 5;
-	unsigned mov_immediate : 16;
-	unsigned quadrant      : 2;
-	unsigned opcode        : 9;
-} ifmt_iw_t;
+constexpr uint8_t  instrRd(uint32_t instruction)         { return (uint8_t)instrField(instruction, 0, 5);   } /* R, I: Rd | D, CB, IW: Rt */
+constexpr uint8_t  instrRn(uint32_t instruction)         { return (uint8_t)instrField(instruction, 5, 5);   } /* R, I, D */
+constexpr uint8_t  instrShamt(uint32_t instruction)      { return (uint8_t)instrField(instruction, 10, 6);  } /* R  */
+constexpr uint8_t  instrRm(uint32_t instruction)         { return (uint8_t)instrField(instruction, 16, 5);  } /* R  */
+constexpr uint16_t instrALUImm(uint32_t instruction)     { return (uint16_t)instrField(instruction, 10, 12); } /* I */
+constexpr uint8_t  instrDTOp(uint32_t instruction)       { return (uint8_t)instrField(instruction, 10, 2);  } /* D  */
+constexpr uint16_t instrDTAddr(uint32_t instruction)     { return (uint16_t)instrField(instruction, 12, 9); } /* D  */
+constexpr uint32_t instrBrAddr(uint32_t instruction)     { return instrField(instruction, 0, 26);           } /* B  */
+constexpr uint32_t instrCondBrAddr(uint32_t instruction) { return instrField(instruction, 5, 19);           } /* CB */
+constexpr uint16_t instrMOVImm(uint32_t instruction)     { return (uint16_t)instrField(instruction, 5, 16); } /* IW */
+constexpr uint8_t  instrQuadrant(uint32_t instruction)   { return (uint8_t)instrField(instruction, 21, 2);  } /* IW */
 
-#define INSTR_TO_IFMT_IW(instruction) ((ifmt_iw_t*)&instruction)
+static_assert(instrRm(0x001F0000) == 31 && instrDTAddr(0x001FF000) == 0x1FF && instrQuadrant(0x00600000) == 3, "The instruction field layout is off");
 
 enum CONDITION_CODES { /* Note: condition codes are not 0 indexed */
 	BEQ = 1, /* Branch if equal (==)                 */
@@ -157,7 +134,12 @@ enum OPCODE {
 	SINT  = 0x520, RETI  = 0x580,
 	/* VIRTUAL MEMORY */
 	LPDP  = 0x4F4, SPDP  = 0x4D4,
-	LPFLA = 0x4B4
+	LPFLA = 0x4B4,
+	/* MULTIPROCESSING */
+	SCID  = 0x494, SIPI  = 0x474,
+	/* ATOMIC READ-MODIFY-WRITE */
+	CAS   = 0x454, LDADD = 0x434, SWP   = 0x414,
+	DMBA  = 0x3F4, DMBR  = 0x3D4
 };
 
 /*********************************/
@@ -181,7 +163,8 @@ enum SPECIAL_REGISTERS {
 	SPECIAL_IVP, /* Interrupt Vector Pointer  */
 	SPECIAL_EVP, /* Exception Vector Pointer  */
 	SPECIAL_PDP, /* Page Directory Pointer    */
-	SPECIAL_PFLA /* Page Fault Linear Address */
+	SPECIAL_PFLA, /* Page Fault Linear Address */
+	SPECIAL_CID   /* Core ID (read only)       */
 };
 
 typedef struct {
@@ -213,6 +196,13 @@ enum FISC_DATATYPE {
 	FISC_SZ__COUNT
 };
 
+enum FISC_ATOMIC_OP {
+	FISC_ATOMIC_CAS,  /* Compare and swap */
+	FISC_ATOMIC_ADD,  /* Fetch and add    */
+	FISC_ATOMIC_SWAP, /* Swap             */
+	FISC_ATOMIC__COUNT
+};
+
 enum FISC_RETTYPE {
 	FISC_RET_NULL,
 	FISC_RET_OK,      /* Used to indicate successful instruction execution                                */
@@ -283,7 +273,8 @@ enum EXCEPTION_CODE {
 	EXC_DOUBLEINTERRUPT, 
 	EXC_DOUBLEFAULT,
 	EXC_PERMFAULT,
-	EXC_PAGEFAULT
+	EXC_PAGEFAULT,
+	EXC_ALIGNFAULT /* An exclusive / atomic access that is not naturally aligned */
 };
 
 /*********************************/
@@ -298,19 +289,39 @@ extern unsigned int instruction_list_size;
 extern bool instruction_list_success_declared;
 
 class CPUModule;
+struct decoded_op;
+
+typedef enum FISC_RETTYPE (*instruction_handler_t)(const struct decoded_op * _this_, CPUModule * _cpu_);
+
+#define FISC_MAX_INSTRUCTIONS 256 /* decoded_op_t::id is only 8 bits wide */
+
+/* The decoded form of one instruction word. This is a small value type
+   (so it fits nicely inside the decode cache) and it is never shared
+   between instruction words. The heavy metadata (mnemonic, format, etc.)
+   stays on the Instruction objects, which are indexed by 'id' */
+typedef struct decoded_op {
+	instruction_handler_t handler; /* The function that executes this instruction */
+	union { /* The immediate field (of any format) */
+		uint32_t imm, shamt, alu_immediate, dt_address, br_address, cond_br_address, mov_immediate;
+	};
+	union { uint8_t rd, rt; };            /* R, I: Rd | D, CB, IW: Rt */
+	uint8_t rn;                           /* R, I, D: Rn              */
+	union { uint8_t rm, op, quadrant; };  /* R: Rm | D: op | IW: quadrant */
+	uint8_t id;                           /* Index of the instruction on the CPU Configurator's instruction list */
+} decoded_op_t;
+
+static_assert(sizeof(decoded_op_t) <= 16, "decoded_op_t should fit in 16 bytes");
 
 class Instruction {
 public:
-	Instruction(enum OPCODE opcode, std::string opcodeStr, enum INSTRUCTION_FMT format, std::function<enum FISC_RETTYPE(Instruction*, CPUModule*)> operation)
+	Instruction(enum OPCODE opcode, std::string opcodeStr, enum INSTRUCTION_FMT format, instruction_handler_t operation)
 	{
-		this->instruction = (uint32_t)-1;
+		this->id = 0;
 		this->opcode = opcode;
 		if(opcodeStr == "STR_") opcodeStr = "STR"; /* Small silly fix */
 		this->opcodeStr = opcodeStr;
 		this->format = format;
 		this->operation = operation;
-		this->retStr = NULLSTR;
-		this->timesExecuted = 0;
 		this->passOwner = nullptr;
 
 		initialized = true;
@@ -328,6 +339,7 @@ public:
 				break;
 			case IFMT_D:
 				this->opcodeShifted = this->opcode;
+				this->opcodeSize = 11;
 				this->formatStr = "D";
 				break;
 			case IFMT_B:
@@ -355,20 +367,7 @@ public:
 				break;
 		}
 
-		for (unsigned int i = 0; i < instruction_list_size; i++) {
-			if (instruction_list_realloc[i]->opcodeShifted == this->opcodeShifted)
-			{
-				/* Oh no, there is a conflict between instructions */
-				debug::DEBUG(DERROR, "FATAL ERROR: The instruction %s (opcode 0x%X) is in conflict with instruction %s (opcode 0x%X)", 
-					this->opcodeStr.c_str(), this->opcode,
-					instruction_list_realloc[i]->opcodeStr.c_str(), instruction_list_realloc[i]->opcode);
-				free(instruction_list_realloc);
-				instruction_list_realloc = nullptr;
-				instruction_list_size = 0;
-				instruction_list_success_declared = false; /* Prevent all the other instructions from being initialized */
-			}
-		}
-
+		/* Opcode conflicts are detected once the CPU Configurator builds its opcode table */
 		if(instruction_list_success_declared) {
 			instruction_list_size++;
 			instruction_list_realloc = (Instruction**)realloc(instruction_list_realloc, instruction_list_size * sizeof(Instruction*));
@@ -376,30 +375,25 @@ public:
 		}
 	}
 
-	uint32_t instruction;
-	ifmt_r_t  * ifmt_r;
-	ifmt_i_t  * ifmt_i;
-	ifmt_d_t  * ifmt_d;
-	ifmt_b_t  * ifmt_b;
-	ifmt_cb_t * ifmt_cb;
-	ifmt_iw_t * ifmt_iw;
+	uint8_t id;
 	enum OPCODE opcode;
 	uint16_t opcodeShifted;
 	std::string opcodeStr;
 	unsigned int opcodeSize;
 	enum INSTRUCTION_FMT format;
 	std::string formatStr;
-	std::function<enum FISC_RETTYPE(Instruction*, CPUModule*)> operation;
+	instruction_handler_t operation;
 	std::string targetName;
-	std::string retStr;
-	uint32_t timesExecuted;
 	bool initialized;
 	CPUModule * passOwner;
 };
 
-#define NEW_INSTRUCTION(targetname, mnemonic, format, operation) static Instruction targetname ## _instruction_ ## mnemonic(mnemonic, STRING(mnemonic), format, [] (Instruction * _this_, CPUModule * _cpu_) operation)
+/* Every instruction body becomes a plain static function (its handler), registered by a static Instruction object */
+#define NEW_INSTRUCTION(targetname, mnemonic, format, operation) \
+	static enum FISC_RETTYPE targetname ## _handler_ ## mnemonic(const decoded_op_t * _this_, CPUModule * _cpu_) operation \
+	static Instruction targetname ## _instruction_ ## mnemonic(mnemonic, STRING(mnemonic), format, targetname ## _handler_ ## mnemonic)
 
-#define RETURN(type, msg) do{ _this_->retStr = msg; return type; } while(0);
+#define RETURN(type, msg) do{ _cpu_->setReturnMessage(msg); return type; } while(0);
 
 #define ALIGN_BASE(base, op) (op == 1 ? base : op == 2 ? ALIGN16(base) : op == 3 ? ALIGN32(base) : op == 0 ? ALIGN64(base) : -1)
 #define ALIGN_DTADDR(dtaddr, op) (op == 1 ? dtaddr : op == 2 ? ALIGN16(dtaddr) : op == 3 ? ALIGN32(dtaddr) : op == 0 ? ALIGN64(dtaddr) : -1)
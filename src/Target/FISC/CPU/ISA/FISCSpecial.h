@@ -10,10 +10,10 @@
 NEW_INSTRUCTION(FISC, MSR, RF, /* Operation: CPSR/SPSR_x? = R[Rn] (Note: the _x field is in R[Rd])*/
 {
 	/* 1- Read the actual contents we will write into the destination register */
-	uint64_t rnReg = _cpu_->readRegister(_this_->ifmt_r->rn);
+	uint64_t rnReg = _cpu_->readRegister(_this_->rn);
 
 	/* 2- Get the CPSR/SPSR field to which we will be writing into */
-	uint16_t cpsr_field = _cpu_->readRegister(_this_->ifmt_r->rd) & 0x1F;
+	uint16_t cpsr_field = _cpu_->readRegister(_this_->rd) & 0x1F;
 	
 	/* 3- Read CPSR */
 	uint64_t cpsrRegVal = _cpu_->readRegister(SPECIAL_CPSR);
@@ -106,7 +106,7 @@ NEW_INSTRUCTION(FISC, MRS, RF, /* Operation: R[Rd] = CPSR/SPSR_x? (Note: the _x
 	uint64_t rdReg = (uint64_t)-1;
 
 	/* 2- Get the CPSR/SPSR field to which we will be reading from */
-	uint16_t cpsr_field = _cpu_->readRegister(_this_->ifmt_r->rn) & 0x1F;
+	uint16_t cpsr_field = _cpu_->readRegister(_this_->rn) & 0x1F;
 
 	/* 3- Read CPSR (and cast it into a pointer for ease of use) */
 	uint64_t cpsrRegVal = _cpu_->readRegister(SPECIAL_CPSR);
@@ -168,7 +168,7 @@ NEW_INSTRUCTION(FISC, MRS, RF, /* Operation: R[Rd] = CPSR/SPSR_x? (Note: the _x
 	}
 
 	/* 9- Finally, write to the destination General Purpose register */
-	return _cpu_->writeRegister(_this_->ifmt_r->rd, rdReg, false, 0, 0, 0);
+	return _cpu_->writeRegister(_this_->rd, rdReg, false, 0, 0, 0);
 });
 
 /**************************************************************/
@@ -176,37 +176,37 @@ NEW_INSTRUCTION(FISC, MRS, RF, /* Operation: R[Rd] = CPSR/SPSR_x? (Note: the _x
 /**************************************************************/
 NEW_INSTRUCTION(FISC, LIVP, RF, /* Operation: IVP = R[Rd] */
 {
-	return _cpu_->writeRegister(SPECIAL_IVP, _cpu_->readRegister(_this_->ifmt_r->rd), false, 0, 0, 0);
+	return _cpu_->writeRegister(SPECIAL_IVP, _cpu_->readRegister(_this_->rd), false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, SIVP, RF, /* Operation: R[Rd] = IVP */
 {
-	return _cpu_->writeRegister(_this_->ifmt_r->rd, _cpu_->readRegister(SPECIAL_IVP), false, 0, 0, 0);
+	return _cpu_->writeRegister(_this_->rd, _cpu_->readRegister(SPECIAL_IVP), false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, LEVP, RF, /* Operation: EVP = R[Rd] */
 {
-	return _cpu_->writeRegister(SPECIAL_EVP, _cpu_->readRegister(_this_->ifmt_r->rd), false, 0, 0, 0);
+	return _cpu_->writeRegister(SPECIAL_EVP, _cpu_->readRegister(_this_->rd), false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, SEVP, RF, /* Operation:  R[Rd] = EVP */
 {
-	return _cpu_->writeRegister(_this_->ifmt_r->rd, _cpu_->readRegister(SPECIAL_EVP), false, 0, 0, 0);
+	return _cpu_->writeRegister(_this_->rd, _cpu_->readRegister(SPECIAL_EVP), false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, SESR, RF, /* Operation: R[Rd] = ESR */
 {
-	return _cpu_->writeRegister(_this_->ifmt_r->rd, _cpu_->readRegister(SPECIAL_ESR), false, 0, 0, 0);
+	return _cpu_->writeRegister(_this_->rd, _cpu_->readRegister(SPECIAL_ESR), false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, SINT, BF, /* Operation: CPSR_IEN[1] = 0; PC = IVP + INT_ID */
 {
-	return _cpu_->triggerSoftInterrupt(_this_->ifmt_b->br_address);
+	return _cpu_->triggerSoftInterrupt(_this_->br_address);
 });
 
 NEW_INSTRUCTION(FISC, RETI, BF, /* Operation: PC = ELR; CPSR_IEN[1] = 1; */
 {
-	return _cpu_->intExcReturn(_this_->ifmt_b->br_address);
+	return _cpu_->intExcReturn(_this_->br_address);
 });
 
 /**************************************************************/
@@ -214,17 +214,32 @@ NEW_INSTRUCTION(FISC, RETI, BF, /* Operation: PC = ELR; CPSR_IEN[1] = 1; */
 /**************************************************************/
 NEW_INSTRUCTION(FISC, LPDP, RF, /* Operation: PDP = R[Rd] */
 {
-	return _cpu_->writeRegister(SPECIAL_PDP, _cpu_->readRegister(_this_->ifmt_r->rd), false, 0, 0, 0);
+	return _cpu_->writeRegister(SPECIAL_PDP, _cpu_->readRegister(_this_->rd), false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, SPDP, RF, /* Operation: R[Rd] = PDP */
 {
-	return _cpu_->writeRegister(_this_->ifmt_r->rd, _cpu_->readRegister(SPECIAL_PDP), false, 0, 0, 0);
+	return _cpu_->writeRegister(_this_->rd, _cpu_->readRegister(SPECIAL_PDP), false, 0, 0, 0);
 });
 
 NEW_INSTRUCTION(FISC, LPFLA, RF, /* Operation: R[Rd] = PDP */
 {
-	return _cpu_->writeRegister(_this_->ifmt_r->rd, _cpu_->readRegister(SPECIAL_PFLA), false, 0, 0, 0);
+	return _cpu_->writeRegister(_this_->rd, _cpu_->readRegister(SPECIAL_PFLA), false, 0, 0, 0);
+});
+
+/**************************************************************/
+/**************** MULTIPROCESSING INSTRUCTIONS ****************/
+/**************************************************************/
+NEW_INSTRUCTION(FISC, SCID, RF, /* Operation: R[Rd] = CID */
+{
+	return _cpu_->writeRegister(_this_->rd, _cpu_->readRegister(SPECIAL_CID), false, 0, 0, 0);
+});
+
+NEW_INSTRUCTION(FISC, SIPI, RF, /* Operation: Interrupt core R[Rd] with the interrupt code R[Rn] */
+{
+	if (!_cpu_->sendInterProcessorInterrupt((unsigned)_cpu_->readRegister(_this_->rd), (unsigned)_cpu_->readRegister(_this_->rn)))
+		RETURN(FISC_RET_WARNING, "The target core (or the interrupt code) of the IPI does not exist");
+	return FISC_RET_OK;
 });
 
 #endif
\ No newline at end of file
@@ -30,27 +30,51 @@ public:
 
 	/* IO Controller properties */
 	#define IOMEMLOC (0x500000) /* The starting offset of the IO Address Space (byte aligned) */
+	#define IOMAP_GRANULE (0x1000) /* The granularity of the IO page map (one guest page) */
 #pragma endregion
 
 #pragma region REGION 2: THE IO MACHINE STRUCTURE DEFINITION (IMPL. SPECIFIC)
 public:
 	std::vector<Device*> device_list;
 	uint32_t ioSpaceSize; /* Size of IO Address space in bytes */
+
+	/* The flat map of the IO address space, built once the devices are installed */
+	typedef struct {
+		uint32_t start;  /* First physical address of the device      */
+		uint32_t end;    /* One past its last physical address        */
+		uint32_t offset; /* Its offset into the IO address space      */
+		Device * device;
+	} io_range_t;
+	std::vector<io_range_t> ioRanges;     /* Sorted by address, empty devices left out            */
+	std::vector<uint32_t>   ioPageRange;  /* Per IO page: the first range that overlaps that page */
 #pragma endregion
 
 #pragma region REGION 3: THE IO MACHINE CONFIGURATION IMPLEMENTATION (IMPL SPECIFIC)
 public:
-	Device * isAddressIO(uint32_t physAddress)
+	/* Finds the device mapped at a physical address, along with its offset into the IO address space.
+	   Anything outside the IO address space (i.e. RAM) is rejected with a single compare */
+	inline Device * findIODevice(uint32_t physAddress, uint32_t & deviceOffset)
 	{
-		uint32_t addrAccum = IOMEMLOC;
-		for (auto & dev : device_list) {
-			if(physAddress >= addrAccum && physAddress < (addrAccum + dev->addressSpaceSize))
-				return dev;
-			addrAccum += dev->addressSpaceSize;
+		if (physAddress - IOMEMLOC >= ioSpaceSize)
+			return nullptr;
+
+		/* Only the ranges that share the address' page need to be looked at (usually just one) */
+		uint32_t rangeIdx = ioPageRange[(physAddress - IOMEMLOC) / IOMAP_GRANULE];
+		for (; rangeIdx < ioRanges.size() && ioRanges[rangeIdx].start <= physAddress; rangeIdx++) {
+			if (physAddress < ioRanges[rangeIdx].end) {
+				deviceOffset = ioRanges[rangeIdx].offset;
+				return ioRanges[rangeIdx].device;
+			}
 		}
 		return nullptr;
 	}
 
+	Device * isAddressIO(uint32_t physAddress)
+	{
+		uint32_t deviceOffset;
+		return findIODevice(physAddress, deviceOffset);
+	}
+
 	Device * getDevice(std::string deviceName)
 	{
 		for(auto & dev : device_list)
@@ -65,19 +89,34 @@ public:
 		if(device == nullptr)
 			return (uint32_t)-1;
 
-		uint32_t offset = 0;
-
-		for (auto & dev : device_list)
-		{
-			if (device == dev)
-				return offset; /* Device found */
-			else
-				offset += dev->addressSpaceSize;
-		}
+		for (auto & range : ioRanges)
+			if (range.device == device)
+				return range.offset; /* Device found */
 
 		/* Device not found */
 		return (uint32_t)-1;
 	}
+
+private:
+	void buildIOMap()
+	{
+		/* The devices sit back to back in the order they were declared */
+		ioRanges.clear();
+		uint32_t offset = 0;
+		for (auto & dev : device_list) {
+			if (dev->addressSpaceSize > 0)
+				ioRanges.push_back({ IOMEMLOC + offset, IOMEMLOC + offset + dev->addressSpaceSize, offset, dev });
+			offset += dev->addressSpaceSize;
+		}
+
+		ioPageRange.assign((ioSpaceSize + IOMAP_GRANULE - 1) / IOMAP_GRANULE, (uint32_t)ioRanges.size());
+		for (uint32_t i = (uint32_t)ioRanges.size(); i-- > 0;) {
+			uint32_t firstPage = (ioRanges[i].start - IOMEMLOC) / IOMAP_GRANULE;
+			uint32_t lastPage  = (ioRanges[i].end - 1 - IOMEMLOC) / IOMAP_GRANULE;
+			for (uint32_t page = firstPage; page <= lastPage; page++)
+				ioPageRange[page] = i;
+		}
+	}
 #pragma endregion
 
 #pragma region REGION 4: THE IO MACHINE CONFIGURATION IMPLEMENTATION (GENERIC VM FUNCTIONS)
@@ -106,6 +145,7 @@ public:
 				ioSpaceSize += device_list_realloc[i]->addressSpaceSize;
 				device_list.push_back(device_list_realloc[i]);
 			}
+			buildIOMap();
 
 			if (success == PASS_RET_OK) {
 				/* We shall continue initialization */
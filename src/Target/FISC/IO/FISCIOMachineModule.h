@@ -7,6 +7,7 @@ namespace FISC {
 
 class CPUModule;
 class IOMachineConfigurator;
+class Device;
 
 class IOMachineModule : public RunPass {
 #pragma region REGION 1: THE IO MACHINE CONFIGURATION DATA
@@ -28,6 +29,7 @@ private:
 #pragma region REGION 3: THE IO MACHINE BEHAVIOUR IMPLEMENTATION (IMPL SPECIFIC)
 public:
     bool isLive();
+    Device * getDevice(std::string deviceName);
 private:
     enum DevRetcode pollGlobalIO();
     enum PassRetcode collectDevices();
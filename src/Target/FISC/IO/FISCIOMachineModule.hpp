@@ -38,6 +38,11 @@ bool IOMachineModule::isLive()
     return isIOLive;
 }
 
+Device * IOMachineModule::getDevice(std::string deviceName)
+{
+    return ioconf->getDevice(deviceName);
+}
+
 enum DevRetcode IOMachineModule::pollGlobalIO()
 {
     enum DevRetcode ret = DEV_RET_OK;
@@ -0,0 +1,88 @@
+#ifndef FISCPIC8259MODULE_H_
+#define FISCPIC8259MODULE_H_
+
+#include "../MoboDevice.h"
+#include <atomic>
+
+/* -- Device address allocation --
+Address   |  Operation / Meaning
+---------------------------------
+0         | Enable Device          (1) (0-disable. 1-enable. Enabled on reset)
+1         | Interrupt mask         (1) (1 bit per line. 1-masked)
+2         | Vector base            (1) (the CPU interrupt code of line 0. Line N raises vector base + N)
+3         | Mode                   (1) (bit 0: automatic EOI. Set on reset)
+4         | End of interrupt       (1) (any value: the highest priority line in service is done)
+5         | Get requested lines    (1) (1 bit per line: the IRR)
+6         | Get lines in service   (1) (1 bit per line: the ISR)
+*/
+
+enum PIC8259MODULE_ADDRESS_IOCTL {
+	PIC8259MODULE_ENDEV,
+	PIC8259MODULE_IMR,
+	PIC8259MODULE_VECBASE,
+	PIC8259MODULE_MODE,
+	PIC8259MODULE_EOI,
+	PIC8259MODULE_GETIRR,
+	PIC8259MODULE_GETISR,
+	PIC8259MODULE_ADDRESS_IOCTL__COUNT
+};
+
+/* The interrupt lines, highest priority first */
+enum PIC8259_LINE {
+	PIC_LINE_TIMER,
+	PIC_LINE_KEYBOARD,
+	PIC_LINE_SERIAL,
+	PIC_LINE_RTC,
+	PIC_LINE_FLOPPY,
+	PIC_LINE_ATA,
+	PIC_LINE_HDD,
+	PIC_LINE_MOUSE,
+	PIC_LINES
+};
+
+#define PIC8259_MODE_AUTOEOI (1 << 0) /* Lines leave service as soon as they're delivered (no EOI needed) */
+
+/* Define the size of the address space for this device (in bytes) */
+#define IO_PIC8259MODULE_BANDWIDTH (PIC8259MODULE_ADDRESS_IOCTL__COUNT)
+
+class CPUModule;
+
+/* Every device interrupt goes through here on its way to the CPU.
+   A line that is raised again while its request is still pending is merged into that request,
+   and (unless automatic EOI is on) a line that is in service holds back itself and every line
+   of lower priority until the guest writes the EOI register.
+   Only requests that wait here (masked lines, lines held back by one in service, or a disabled
+   controller) get merged and counted. With automatic EOI (the default) a request leaves as soon
+   as it's raised; an edge that arrives while the guest is still handling the previous one waits
+   as a pending interrupt on the CPU instead, which merges (uncounted) any further repeats */
+class PIC8259Module : public Device {
+private:
+	CPUModule * cpu;
+	uint8_t imr;                        /* The masked lines                                                   */
+	uint8_t isr;                        /* The lines the CPU is servicing (only used without automatic EOI)   */
+	uint8_t vectorBase;                 /* The CPU interrupt code of line 0                                   */
+	uint8_t mode;
+	std::atomic<uint8_t> irr;           /* The lines that were raised and were not yet delivered to the CPU   */
+	std::atomic<uint64_t> coalescedEdges; /* How many raises were merged into a request still pending on the PIC */
+
+	void dispatch();
+
+public:
+	DEV_CONSTR(PIC8259Module)
+	{
+		/* Nothing to construct */
+	}
+
+	bool raiseIRQ(unsigned line);
+
+	enum DevRetcode init();
+	enum DevRetcode finit();
+	enum DevRetcode run(runDevLaunchCommandPacket_t * runCmd);
+	enum DevRetcode poll();
+	enum DevRetcode read(uint64_t & outData, uint32_t address, enum FISC_DATATYPE dataType, bool debug);
+	enum DevRetcode write(uint64_t data, uint32_t address, enum FISC_DATATYPE dataType, bool debug);
+	enum DevRetcode ioctl(void * ioctlPacket);
+	enum DevRetcode watchdog();
+};
+
+#endif
@@ -0,0 +1,180 @@
+/*----------------------------------------------------------------------------------------------------------
+- FILE NAME: FISCPIC8259Module.hpp
+- SUB MODULE NAME: Programmable Interrupt Controller Module
+- PURPOSE: Collects the interrupt lines of the IO devices and dispatches them to the CPU by priority
+- AUTHOR: MIGUEL SANTOS
+-----------------------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include "FISCPIC8259Module.h"
+#include "../../../CPU/FISCCPUModule.h"
+#include <fvm/Debug/Debug.h>
+
+static mutex glob_iomodule_pic_mutex;
+
+void PIC8259Module::dispatch()
+{
+	/* Must be called with glob_iomodule_pic_mutex held */
+	if (!isDeviceEnabled)
+		return; /* The requests wait until the device is enabled */
+
+	uint8_t requests;
+	while ((requests = irr.load(std::memory_order_acquire) & ~imr) != 0) {
+		/* The lowest line has the highest priority */
+		unsigned line = 0;
+		while (!(requests & (1 << line)))
+			line++;
+
+		/* It has to wait while itself (or a line with a higher priority) is in service */
+		if (isr & ((2 << line) - 1))
+			return;
+
+		irr.fetch_and((uint8_t)~(1 << line), std::memory_order_acq_rel);
+		if (!(mode & PIC8259_MODE_AUTOEOI))
+			isr |= 1 << line;
+		cpu->raiseInterrupt(vectorBase + line);
+	}
+}
+
+bool PIC8259Module::raiseIRQ(unsigned line)
+{
+	if (line >= PIC_LINES)
+		return false;
+
+	/* Safe to call from any device's thread. Raising a line whose request is still
+	   pending here doesn't cost the CPU another interrupt (see the class comment for
+	   what happens to the requests that were already delivered) */
+	if (irr.fetch_or((uint8_t)(1 << line), std::memory_order_acq_rel) & (1 << line)) {
+		coalescedEdges.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	LOCK(glob_iomodule_pic_mutex);
+	dispatch();
+	return true;
+}
+
+enum DevRetcode PIC8259Module::init()
+{
+	enum DevRetcode success = DEV_RET_OK;
+
+	/* The controller starts enabled, with every line unmasked and in automatic EOI mode,
+	   so programs that don't know about it keep getting the device interrupts they used to */
+	isDeviceEnabled = true;
+	imr = 0;
+	isr = 0;
+	vectorBase = 0;
+	mode = PIC8259_MODE_AUTOEOI;
+	irr = 0;
+	coalescedEdges = 0;
+
+	if (!(cpu = dynamic_cast<CPUModule*>(ioContext->getPass("CPUModule")))) {
+		/* We were unable to find a CPUModule pass!
+		   We cannot continue the execution of this device */
+		ioContext->DEBUG(DERROR, "Could not fetch the CPU Module Pass at target %s@%s@%s@%s", targetName.c_str(), ioContext->passName.c_str(), deviceName.c_str(), __func__);
+		success = DEV_RET_ERROR;
+	}
+
+	return success;
+}
+
+enum DevRetcode PIC8259Module::finit()
+{
+	if (coalescedEdges > 0)
+		ioContext->DEBUG(DINFO, "%s: %llu interrupt requests were merged into ones pending on the controller", deviceName.c_str(), (unsigned long long)coalescedEdges.load());
+	return DEV_RET_OK;
+}
+
+enum DevRetcode PIC8259Module::run(runDevLaunchCommandPacket_t * runCmd)
+{
+	/* Everything happens when a line is raised or a register is written */
+	return DEV_RET_NOTHINGTODO;
+}
+
+enum DevRetcode PIC8259Module::poll()
+{
+	/* Nothing to poll */
+	return DEV_RET_OK;
+}
+
+enum DevRetcode PIC8259Module::read(uint64_t & outData, uint32_t address, enum FISC_DATATYPE dataType, bool debug)
+{
+	LOCK(glob_iomodule_pic_mutex);
+
+	enum DevRetcode success = DEV_RET_OK;
+
+	/* This device expects to receive the following requests */
+	switch ((enum PIC8259MODULE_ADDRESS_IOCTL)address) {
+	/* Ignore this request for reading */
+	case PIC8259MODULE_ENDEV:
+	case PIC8259MODULE_EOI:
+		break;
+	/*****************/
+	/* Read requests */
+	/*****************/
+	case PIC8259MODULE_IMR:     outData = imr;        break;
+	case PIC8259MODULE_VECBASE: outData = vectorBase; break;
+	case PIC8259MODULE_MODE:    outData = mode;       break;
+	case PIC8259MODULE_GETIRR:  outData = irr.load(std::memory_order_acquire); break;
+	case PIC8259MODULE_GETISR:  outData = isr;        break;
+	default: /* We never get undefined requests. The IO Module makes sure of that */ break;
+	}
+
+	return success;
+}
+
+enum DevRetcode PIC8259Module::write(uint64_t data, uint32_t address, enum FISC_DATATYPE dataType, bool debug)
+{
+	LOCK(glob_iomodule_pic_mutex);
+
+	enum DevRetcode success = DEV_RET_OK;
+
+	/* This device expects to receive the following requests */
+	switch ((enum PIC8259MODULE_ADDRESS_IOCTL)address) {
+	/******************/
+	/* Write requests */
+	/******************/
+	case PIC8259MODULE_ENDEV:
+		isDeviceEnabled = data > 0 ? true : false;
+		break;
+	case PIC8259MODULE_IMR:
+		imr = (uint8_t)data;
+		break;
+	case PIC8259MODULE_VECBASE:
+		/* Every line has to land on an interrupt code the CPU has */
+		vectorBase = (uint8_t)(data < FISC_IRQ_LINES - PIC_LINES ? data : FISC_IRQ_LINES - PIC_LINES);
+		break;
+	case PIC8259MODULE_MODE:
+		mode = (uint8_t)(data & PIC8259_MODE_AUTOEOI);
+		if (mode & PIC8259_MODE_AUTOEOI)
+			isr = 0;
+		break;
+	case PIC8259MODULE_EOI:
+		/* Non specific EOI: the highest priority line in service is done */
+		isr &= isr - 1;
+		break;
+	/* Ignore this request for writing */
+	case PIC8259MODULE_GETIRR:
+	case PIC8259MODULE_GETISR:
+		break;
+	default: /* We never get undefined requests. The IO Module makes sure of that */ break;
+	}
+
+	/* Unmasking, enabling or ending an interrupt might let a pending line through */
+	dispatch();
+	return success;
+}
+
+enum DevRetcode PIC8259Module::ioctl(void * ioctlPacket)
+{
+	/* Nothing to control */
+	return DEV_RET_OK;
+}
+
+enum DevRetcode PIC8259Module::watchdog()
+{
+	return DEV_RET_OK;
+}
+
+/* Register / instantiate device */
+NEW_DEVICE(FISC, PIC8259Module, IO_PIC8259MODULE_BANDWIDTH);
@@ -7,7 +7,7 @@
 
 #pragma once
 #include "../MoboDevice.h"
-#include "../../../CPU/FISCCPUModule.h"
+#include "../InterruptController/FISCPIC8259Module.h"
 #include <fvm/Debug/Debug.h>
 
 static mutex glob_iomodule_timer_mutex;
@@ -36,10 +36,10 @@ enum TIMERMODULE_ADDRESS_IOCTL {
 
 class TimerModule : public Device {
 private:
-	CPUModule * cpu;
+	PIC8259Module * pic;
 	bool isTimerEnabled;
 
-	#define TIMER_INTCODE                      0        /* The interrupt code of the timer seen by the CPU. This represents the interrupt offset on the interrupt vector for the timer */
+	#define TIMER_IRQ_LINE                     PIC_LINE_TIMER /* The interrupt controller line the timer is wired to                                                                    */
 	#define DEFAULT_TIMER_SLEEPTIME_NS         100000   /* Default sleep time for the timer (in nanosecond scale)                                                                      */
 	#define DEFAULT_TIMER_QUANTA_SLEEPTIME_NS  10000    /* The smallest time atomic scale each sleep trigger sleeps for                                                                */
 	#define DEFAULT_TIMER_MINIMUM_SLEEPTIME_NS 100000   /* The minimum value the variable timerSleeptime can hold                                                                      */
@@ -66,10 +66,10 @@ public:
 		timerSleeptime = DEFAULT_TIMER_SLEEPTIME_NS;
 		sleepCounter = 0;
 		
-		if (!(cpu = dynamic_cast<CPUModule*>(ioContext->getPass("CPUModule")))) {
-			/* We were unable to find a CPUModule pass!
+		if (!(pic = dynamic_cast<PIC8259Module*>(ioContext->getDevice("PIC8259Module")))) {
+			/* We were unable to find the interrupt controller!
 			   We cannot continue the execution of this device */
-			ioContext->DEBUG(DERROR, "Could not fetch the CPU Module Pass at target %s@%s@%s@%s", targetName.c_str(), ioContext->passName.c_str(), deviceName.c_str(), __func__);
+			ioContext->DEBUG(DERROR, "Could not fetch the PIC8259Module device at target %s@%s@%s@%s", targetName.c_str(), ioContext->passName.c_str(), deviceName.c_str(), __func__);
 			success = DEV_RET_ERROR;
 		}
 
@@ -95,8 +95,8 @@ public:
 				timerSleep();
 #endif
 				if (++sleepCounter >= timerSleeptime) {
-					/* Trigger CPU hardware interrupt */
-					cpu->triggerHardInterrupt(TIMER_INTCODE);
+					/* Raise the timer's interrupt line */
+					pic->raiseIRQ(TIMER_IRQ_LINE);
 					sleepCounter = 0;
 				}
 			}
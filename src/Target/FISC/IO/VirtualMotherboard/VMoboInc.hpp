@@ -11,7 +11,7 @@
 	Device 2 -
 		Timer
 	Description -
-		Keeps triggering the CPU interrupt wire
+		Keeps triggering its interrupt line on the PIC
 
 	Device 3 -
 		VGA
@@ -27,6 +27,11 @@
 		Mouse
 	Description -
 		Reads user input through a virtual mouse that is associated with the VGA display device
+
+	Device 6 -
+		8259 PIC
+	Description -
+		Dispatches the interrupt lines of the other devices to the CPU (masked, by priority, and merging repeated ones)
 */
 
 #include "Communication/FISCVMConsole.hpp"
@@ -34,3 +39,4 @@
 #include "Video/FISCVGAModule.hpp"
 #include "Input/FISCKeyboardModule.hpp"
 #include "Input/FISCMouseModule.hpp"
+#include "InterruptController/FISCPIC8259Module.hpp"
@@ -28,10 +28,13 @@
 #include <fvm/Utils/String.h>
 #include <fvm/Utils/IO/File.h>
 #include <fvm/Utils/ELFLoader.h>
+#include <fvm/Utils/Hash.h>
+#include "FISCMemoryRAM.h"
 #include <fstream>
+#include <stdexcept>
 #include <vector>
-#include <bitset>
 #include <stdint.h>
+#include <ctype.h>
 
 namespace FISC {
 
@@ -48,29 +51,64 @@ public:
     /* Command line flags */
     #define MEMORY_FLAG_BOOT_SHORT 'b'
     #define MEMORY_FLAG_BOOT_LONG "boot"
+    #define MEMORY_FLAG_SIZE "mem" /* --mem=<bytes>[K|M|G]: size of the main memory */
 
     /* Implementation properties */
     #define MEMORY_WIDTH   8        /* The width of the memory */
-    #define MEMORY_DEPTH   33554432 /* Size of memory in bytes */
+    #define MEMORY_DEPTH   33554432 /* Default size of memory in bytes */
+    #define MEMORY_DEPTH_MIN 4096ULL       /* Smallest memory size allowed (one page) */
+    #define MEMORY_DEPTH_MAX 0x100000000ULL /* Largest memory size allowed (the whole 32-bit physical address space) */
     #define MEMORY_LOADLOC 0        /* Where to load the program on startup */
 #pragma endregion
 
 #pragma region REGION 2: THE MEMORY STRUCTURE DEFINITION (IMPL. SPECIFIC)
 public:
-    std::vector<std::bitset<MEMORY_WIDTH> > theMemory; /* The actual main memory */
-    /* The following vector will hold the initial bootloader program in ELF file format, 
-       which will be then copied into the main memory once parsed and relocated */
-    std::vector<std::bitset<MEMORY_WIDTH> > theBootloaderMemory;
+    GuestRAM theMemory; /* The actual main memory (one contiguous, lazily committed byte buffer) */
     uint64_t loadedProgramSize; /* Size of the loaded program */
+    uint64_t programHash;       /* Hash of the program image, as it was read from the file */
     File programFile; /* The file being loaded into memory */
     /* DISCLAIMER: In the future, we might want to care about a singular
        file being loaded into memory as the absolute program being loaded. 
        In other words, the first program that is loaded might be responsible for
        loading other files, thus rendering this variable useless. */
-    elfsection_list_t elfsection_list;
+    elfimage_t elfImage; /* Entry point, sections and symbols of the program (only the entry point is set for flat binaries) */
 #pragma endregion
 
 #pragma region REGION 3: THE MEMORY CONFIGURATION IMPLEMENTATION (IMPL SPECIFIC)
+private:
+    /* Parses a memory size such as "1073741824", "0x40000000", "512M" or "2G". Returns 0 if it's malformed
+       and UINT64_MAX if it does not even fit in 64 bits (so that it gets rejected as too large) */
+    uint64_t parseMemSize(std::string sizeStr)
+    {
+        uint64_t multiplier = 1;
+        if (!sizeStr.empty()) {
+            switch (toupper(sizeStr.back())) {
+            case 'K': multiplier = 1ULL << 10; break;
+            case 'M': multiplier = 1ULL << 20; break;
+            case 'G': multiplier = 1ULL << 30; break;
+            }
+            if (multiplier != 1)
+                sizeStr.pop_back();
+        }
+        if (sizeStr.empty() || !strIsNumber(sizeStr))
+            return 0;
+
+        uint64_t size;
+        try {
+            size_t parsed = 0;
+            size = std::stoull(sizeStr, &parsed, 0);
+            if (parsed != sizeStr.size())
+                return 0;
+        }
+        catch (const std::invalid_argument &) {
+            return 0;
+        }
+        catch (const std::out_of_range &) {
+            return UINT64_MAX;
+        }
+        return size > UINT64_MAX / multiplier ? UINT64_MAX : size * multiplier;
+    }
+
 public:
     uint64_t getMemSize()
     {
@@ -86,7 +124,7 @@ public:
 #pragma region REGION 4: THE MEMORY CONFIGURATION IMPLEMENTATION (GENERIC VM FUNCTIONS)
 public:
     MemoryConfigurator() : ConfigPass(MEMORY_CONFIGURATOR_PRIORITY),
-        loadedProgramSize(0), theMemory(MEMORY_DEPTH, -1), programFile(NULLSTR, 0)
+        loadedProgramSize(0), programHash(0), programFile(NULLSTR, 0)
     {
         setWhitelist(WHITELIST_MEM_CONFIG);
     }
@@ -119,6 +157,31 @@ public:
             }
         }
 
+        /* Reserve the main memory. Nothing is committed until the guest touches it */
+        uint64_t memSize = MEMORY_DEPTH;
+        if (cmdHasOpt(MEMORY_FLAG_SIZE)) {
+            std::string sizeStr = cmdQuery(MEMORY_FLAG_SIZE).second;
+            uint64_t requestedSize = parseMemSize(sizeStr);
+            if (requestedSize == 0) {
+                DEBUG(DERROR, "Malformed memory size '%s' (expected a number of bytes, optionally followed by K, M or G)", sizeStr.c_str());
+                success = PASS_RET_ERR;
+            }
+            else if (requestedSize > MEMORY_DEPTH_MAX) {
+                DEBUG(DERROR, "The memory size '%s' is too large: the physical address space is 32-bit, so the VM can have at most 4G", sizeStr.c_str());
+                success = PASS_RET_ERR;
+            }
+            else if (requestedSize < MEMORY_DEPTH_MIN) {
+                DEBUG(DERROR, "The memory size '%s' is too small: the VM needs at least 4K (one page)", sizeStr.c_str());
+                success = PASS_RET_ERR;
+            }
+            else
+                memSize = (requestedSize + 4095) & ~4095ULL; /* Whole pages only */
+        }
+        if (!theMemory.reserve(memSize)) {
+            DEBUG(DERROR, "Could not reserve %llu bytes for the main memory!", (unsigned long long)memSize);
+            success = PASS_RET_ERR;
+        }
+
         /* If the variable success is equal to PASS_RET_ERR,
            we must tell the top layer (VM) that this module
            will not be able to continue, thus forcing every other
@@ -130,7 +193,7 @@ public:
 
     enum PassRetcode finit()
     {
-        /* Nothing to do for now */
+        theMemory.release();
         return PASS_RET_OK;
     }
 
@@ -25,16 +25,33 @@
 #pragma once
 #include <fvm/Pass.h>
 #include <fvm/Utils/IO/File.h>
+#include <fvm/Utils/IO/MappedFile.h>
 #include <fvm/Utils/ELFLoader.h>
 #include <fvm/Utils/Bit.h>
+#include <fvm/Utils/Endian.h>
+#include <fvm/Utils/Atomic.h>
 #include <fvm/TargetRegistry.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <string.h>
 #include "FISCMemoryConfigurator.hpp"
 #include "../IO/FISCIOMachineConfigurator.hpp"
 #include "../CPU/ISA/FISCISA.h"
 
 namespace FISC {
 
-static mutex glob_memorymodule_mutex;
+/* Memory concurrency model:
+   - RAM loads and stores from the CPU are plain host accesses and take no lock. A naturally
+     aligned access is single-copy atomic (the host does it with one load / store)
+   - Exclusive and atomic accesses (LDXR / STXR, CAS, LDADD, SWP) are host atomics on the RAM itself
+   - No device accesses RAM directly. Anything that needs to write guest memory does it through
+     write(), same as the CPU
+   - Every writer marks the pages it writes in the (atomic) page write bitmap, which is what
+     keeps the predecoded instructions of every CPU core coherent */
+
+static_assert(FISC_MAX_CORES <= 32, "The page write bitmap only has room for 32 cores");
 
 class MemoryModule : public RunPass {
 #pragma region REGION 1: THE MEMORY CONFIGURATION DATA
@@ -57,123 +74,89 @@ private:
     /* External Pass handles */
     MemoryConfigurator * mconf;
     IOMachineConfigurator * ioconf;
+
+    /* One bit per CPU core for every guest physical page, all set whenever the page is written to.
+       Each core uses its own bit to drop its predecoded instructions of that page (self modifying code) */
+    std::unique_ptr<std::atomic<uint32_t>[]> pageWriteBitmap;
+    uint32_t pageCount;
 #pragma endregion
 
 #pragma region REGION 3: THE MEMORY BEHAVIOUR (IMPL. SPECIFIC)
 public:
-    uint64_t read(uint32_t address, enum FISC_DATATYPE dataType, bool forceAlign, bool isMMUOn, bool isLittleEndian, bool debug)
+    /* The accessors come in one instantiation per combination of tracing and forced alignment,
+       so the common (untraced, unaligned) access doesn't test for either of them */
+    template<bool Trace, bool ForceAlign>
+    uint64_t readAs(uint32_t address, enum FISC_DATATYPE dataType, bool isMMUOn, bool isLittleEndian, bool debug)
     {
         /* Align (or not) the address */
-        if(forceAlign)
+        if(ForceAlign)
             alignAddress(address, dataType);
 
-        if(debug && showExecution)
+        if(Trace)
             DEBUG(DNORMALH, " (mrd @0x%X/%s al=%d vm=%d", address, 
                 dataType == FISC_SZ_8 ? "8bit" : dataType == FISC_SZ_16 ? "16bit" : dataType == FISC_SZ_32 ? "32bit" : dataType == FISC_SZ_64 ? "64bit" : "INVAL", 
-                forceAlign, isMMUOn);
-
-        /* Check if address is valid */
-        if(!isAddressValid(address, dataType))
-            return (uint64_t)-1;
+                ForceAlign, isMMUOn);
 
         /* Check if this address falls inside IO Space */
         Device * dev;
-        if ((dev = ioconf->isAddressIO(address)) != nullptr) {
+        uint32_t deviceOffset;
+        if ((dev = ioconf->findIODevice(address, deviceOffset)) != nullptr) {
             /* Redirect the read request into the IO Controller */
-            if (debug && showExecution)
+            if (Trace)
                 DEBUG(DNORMALH, ": @IODEV)");
             
             uint64_t ioval = (uint64_t)-1;
             enum DevRetcode ioret = DEV_RET_ERROR;
-            if ((ioret = dev->read(ioval, address - IOMEMLOC - ioconf->getDeviceOffset(dev), dataType, debug)) != DEV_RET_OK) {
+            if ((ioret = dev->read(ioval, address - IOMEMLOC - deviceOffset, dataType, debug)) != DEV_RET_OK) {
                 DEBUG(DERROR, "Could not read from IO device at target %s@%s@%s@%s. Retval: %d", getTarget()->targetName.c_str(), passName.c_str(), dev->deviceName.c_str(), __func__, ioret);
                 return (uint64_t)-1;
             }
             return ioval;
         }
 
+        /* Check if address is valid */
+        if(!isAddressValid(address, dataType))
+            return (uint64_t)-1;
+
         /* Fetch the memory */
         uint64_t memVal = (uint64_t)-1;
         switch (dataType) {
-        case FISC_SZ_8:
-            memVal = mconf->theMemory[address].to_ulong();
-            break;
-        case FISC_SZ_16:
-            if(isLittleEndian)
-                memVal = (mconf->theMemory[address + 1].to_ulong() << 8) |
-                          mconf->theMemory[address].to_ulong();
-            else
-                memVal = (mconf->theMemory[address].to_ulong() << 8) |
-                          mconf->theMemory[address + 1].to_ulong();
-            break;
-        case FISC_SZ_32:
-            if (isLittleEndian)
-                memVal = (mconf->theMemory[address + 3].to_ulong() << 24) |
-                         (mconf->theMemory[address + 2].to_ulong() << 16) |
-                         (mconf->theMemory[address + 1].to_ulong() << 8)  |
-                          mconf->theMemory[address].to_ulong();
-            else
-                memVal = (mconf->theMemory[address].to_ulong()     << 24) |
-                         (mconf->theMemory[address + 1].to_ulong() << 16) |
-                         (mconf->theMemory[address + 2].to_ulong() << 8)  |
-                          mconf->theMemory[address + 3].to_ulong();
-            break;
-        case FISC_SZ_64:
-            if (isLittleEndian)
-                memVal = ((uint64_t)(mconf->theMemory[address + 7].to_ulong()) << 56) |
-                         ((uint64_t) mconf->theMemory[address + 6].to_ulong()  << 48) |
-                         ((uint64_t) mconf->theMemory[address + 5].to_ulong()  << 40) |
-                         ((uint64_t) mconf->theMemory[address + 4].to_ulong()  << 32) |
-                         ((uint64_t) mconf->theMemory[address + 3].to_ulong()  << 24) |
-                         ((uint64_t) mconf->theMemory[address + 2].to_ulong()  << 16) |
-                         ((uint64_t) mconf->theMemory[address + 1].to_ulong()  << 8)  |
-                          (uint64_t) mconf->theMemory[address].to_ulong();
-            else
-                memVal = ((uint64_t)(mconf->theMemory[address].to_ulong())    << 56) |
-                         ((uint64_t) mconf->theMemory[address + 1].to_ulong() << 48) |
-                         ((uint64_t) mconf->theMemory[address + 2].to_ulong() << 40) |
-                         ((uint64_t) mconf->theMemory[address + 3].to_ulong() << 32) |
-                         ((uint64_t) mconf->theMemory[address + 4].to_ulong() << 24) |
-                         ((uint64_t) mconf->theMemory[address + 5].to_ulong() << 16) |
-                         ((uint64_t) mconf->theMemory[address + 6].to_ulong() << 8)  |
-                          (uint64_t) mconf->theMemory[address + 7].to_ulong();
-            break;
+        case FISC_SZ_8:  memVal = readRAM<uint8_t>(address, isLittleEndian);  break;
+        case FISC_SZ_16: memVal = readRAM<uint16_t>(address, isLittleEndian); break;
+        case FISC_SZ_32: memVal = readRAM<uint32_t>(address, isLittleEndian); break;
+        case FISC_SZ_64: memVal = readRAM<uint64_t>(address, isLittleEndian); break;
         default: /* Invalid data width */ 
-            if(debug && showExecution)
+            if(Trace)
                 DEBUG(DNORMALH, " INVAL SZ)");
             return memVal;
         }
-        if (debug && showExecution)
+        if (Trace)
             DEBUG(DNORMALH, ": 0x%X)", memVal);
         return memVal;
     }
 
-    bool write(uint64_t data, uint32_t address, enum FISC_DATATYPE dataType, bool forceAlign, bool isMMUOn, bool isLittleEndian, bool debug)
+    template<bool Trace, bool ForceAlign>
+    bool writeAs(uint64_t data, uint32_t address, enum FISC_DATATYPE dataType, bool isMMUOn, bool isLittleEndian, bool debug)
     {
-        LOCK(glob_memorymodule_mutex);
-
         /* Align (or not) the address */
-        if (forceAlign)
+        if (ForceAlign)
             alignAddress(address, dataType);
 
-        if(debug && showExecution)
+        if(Trace)
             DEBUG(DNORMALH, " (mwr @0x%X/%s al=%d vm=%d", address,
                 dataType == FISC_SZ_8 ? "8bit" : dataType == FISC_SZ_16 ? "16bit" : dataType == FISC_SZ_32 ? "32bit" : dataType == FISC_SZ_64 ? "64bit" : "INVAL",
-                forceAlign, isMMUOn);
-
-        /* Check if address is valid */
-        if(!isAddressValid(address, dataType))
-            return false;
+                ForceAlign, isMMUOn);
 
         /* Check if this address falls inside IO Space */
         Device * dev;
-        if ((dev = ioconf->isAddressIO(address)) != nullptr) {
+        uint32_t deviceOffset;
+        if ((dev = ioconf->findIODevice(address, deviceOffset)) != nullptr) {
             /* Redirect the write request into the IO Controller */
-            if (debug && showExecution)
+            if (Trace)
                 DEBUG(DNORMALH, ": @IODEV)");
             
             enum DevRetcode ioret = DEV_RET_ERROR;
-            if ((ioret = dev->write(data, address - IOMEMLOC - ioconf->getDeviceOffset(dev), dataType, debug)) != DEV_RET_OK) {
+            if ((ioret = dev->write(data, address - IOMEMLOC - deviceOffset, dataType, debug)) != DEV_RET_OK) {
                 DEBUG(DERROR, "Could not write to IO device at target %s@%s@%s@%s. Retval: %d", getTarget()->targetName.c_str(), passName.c_str(), dev->deviceName.c_str(), __func__, ioret);
                 return false;
             }
@@ -181,76 +164,195 @@ public:
                 return true;
             }
         }
+
+        /* Check if address is valid */
+        if(!isAddressValid(address, dataType))
+            return false;
         
         /* Write to memory */
         switch (dataType) {
-        case FISC_SZ_8:
-            mconf->theMemory[address] = (uint8_t)data;
-            break;
-        case FISC_SZ_16:
-            if (isLittleEndian) {
-                mconf->theMemory[address + 1] = (uint8_t)((data & 0xFF00) >> 8);
-                mconf->theMemory[address]     = (uint8_t)data & 0xFF;
-            } else {
-                mconf->theMemory[address]     = (uint8_t)((data & 0xFF00) >> 8);
-                mconf->theMemory[address + 1] = (uint8_t)data & 0xFF;
-            }
-            break;
-        case FISC_SZ_32:
-            if (isLittleEndian) {
-                mconf->theMemory[address + 3] = (uint8_t)((data & 0xFF000000) >> 24);
-                mconf->theMemory[address + 2] = (uint8_t)((data & 0xFF0000) >> 16);
-                mconf->theMemory[address + 1] = (uint8_t)((data & 0xFF00) >> 8);
-                mconf->theMemory[address]     = (uint8_t)data & 0xFF;
-            } else {
-                mconf->theMemory[address]     = (uint8_t)((data & 0xFF000000) >> 24);
-                mconf->theMemory[address + 1] = (uint8_t)((data & 0xFF0000) >> 16);
-                mconf->theMemory[address + 2] = (uint8_t)((data & 0xFF00) >> 8);
-                mconf->theMemory[address + 3] = (uint8_t)data & 0xFF;
-            }
-            break;
-        case FISC_SZ_64:
-            if (isLittleEndian) {
-                mconf->theMemory[address + 7] = (uint8_t)((data & 0xFF00000000000000) >> 56);
-                mconf->theMemory[address + 6] = (uint8_t)((data & 0xFF000000000000) >> 48);
-                mconf->theMemory[address + 5] = (uint8_t)((data & 0xFF0000000000) >> 40);
-                mconf->theMemory[address + 4] = (uint8_t)((data & 0xFF00000000) >> 32);
-                mconf->theMemory[address + 3] = (uint8_t)((data & 0xFF000000) >> 24);
-                mconf->theMemory[address + 2] = (uint8_t)((data & 0xFF0000) >> 16);
-                mconf->theMemory[address + 1] = (uint8_t)((data & 0xFF00) >> 8);
-                mconf->theMemory[address]     = (uint8_t)data & 0xFF;
-            } else {
-                mconf->theMemory[address]     = (uint8_t)((data & 0xFF00000000000000) >> 56);
-                mconf->theMemory[address + 1] = (uint8_t)((data & 0xFF000000000000) >> 48);
-                mconf->theMemory[address + 2] = (uint8_t)((data & 0xFF0000000000) >> 40);
-                mconf->theMemory[address + 3] = (uint8_t)((data & 0xFF00000000) >> 32);
-                mconf->theMemory[address + 4] = (uint8_t)((data & 0xFF000000) >> 24);
-                mconf->theMemory[address + 5] = (uint8_t)((data & 0xFF0000) >> 16);
-                mconf->theMemory[address + 6] = (uint8_t)((data & 0xFF00) >> 8);
-                mconf->theMemory[address + 7] = (uint8_t)data & 0xFF;
-            }
-            break;
+        case FISC_SZ_8:  writeRAM<uint8_t>(address, (uint8_t)data, isLittleEndian);   break;
+        case FISC_SZ_16: writeRAM<uint16_t>(address, (uint16_t)data, isLittleEndian); break;
+        case FISC_SZ_32: writeRAM<uint32_t>(address, (uint32_t)data, isLittleEndian); break;
+        case FISC_SZ_64: writeRAM<uint64_t>(address, data, isLittleEndian);           break;
         default: /* Invalid data width */ 
-            if (debug && showExecution)
+            if (Trace)
                 DEBUG(DNORMALH, " INVAL SZ)");
             return false;
         }
-        if (debug && showExecution)
+
+        /* Track which pages were modified. Only once the new bytes are there: a core that sees
+           the bit (and re-decodes the page) must never be able to read the old ones */
+        markPagesWritten(address, dataTypeSize(dataType));
+        if (Trace)
             DEBUG(DNORMALH, ": 0x%X)", data);
         return true;
     }
 
-    uint32_t size()
+    uint64_t read(uint32_t address, enum FISC_DATATYPE dataType, bool forceAlign, bool isMMUOn, bool isLittleEndian, bool debug)
+    {
+        if (debug && showExecution)
+            return forceAlign ? readAs<true, true>(address, dataType, isMMUOn, isLittleEndian, debug) : readAs<true, false>(address, dataType, isMMUOn, isLittleEndian, debug);
+        return forceAlign ? readAs<false, true>(address, dataType, isMMUOn, isLittleEndian, debug) : readAs<false, false>(address, dataType, isMMUOn, isLittleEndian, debug);
+    }
+
+    bool write(uint64_t data, uint32_t address, enum FISC_DATATYPE dataType, bool forceAlign, bool isMMUOn, bool isLittleEndian, bool debug)
+    {
+        if (debug && showExecution)
+            return forceAlign ? writeAs<true, true>(data, address, dataType, isMMUOn, isLittleEndian, debug) : writeAs<true, false>(data, address, dataType, isMMUOn, isLittleEndian, debug);
+        return forceAlign ? writeAs<false, true>(data, address, dataType, isMMUOn, isLittleEndian, debug) : writeAs<false, false>(data, address, dataType, isMMUOn, isLittleEndian, debug);
+    }
+
+    uint64_t size()
     {
-        return MEMORY_DEPTH;
+        return mconf->getMemSize();
     }
 
-    elfsection_list_t get_elfsection_list()
+    elfsection_list_t & get_elfsection_list()
     {
-        return mconf->elfsection_list;
+        return mconf->elfImage.sections;
+    }
+
+    elfimage_t & getELFImage()
+    {
+        return mconf->elfImage;
+    }
+
+    uint32_t getEntryPoint()
+    {
+        return mconf->elfImage.entry;
+    }
+
+    uint64_t getProgramHash()
+    {
+        return mconf->programHash;
+    }
+
+    bool wasPageWritten(uint32_t pageIndex, unsigned coreID)
+    {
+        /* Test and clear the core's write tracking bit of the page (the plain load keeps the common case cheap) */
+        uint32_t coreBit = 1u << coreID;
+        if (!(pageWriteBitmap[pageIndex].load(std::memory_order_relaxed) & coreBit))
+            return false;
+        return (pageWriteBitmap[pageIndex].fetch_and(~coreBit, std::memory_order_acq_rel) & coreBit) != 0;
+    }
+
+    /* Whether the address is usable by atomicRMW() / compareExchange() (plain RAM, not IO) */
+    bool isAddressAtomicCapable(uint32_t address, enum FISC_DATATYPE dataType)
+    {
+        return isAddressValid(address, dataType) && !ioconf->isAddressIO(address);
+    }
+
+    bool isAddressAligned(uint32_t address, enum FISC_DATATYPE dataType)
+    {
+        return (address & (dataTypeSize(dataType) - 1)) == 0;
+    }
+
+    /* Atomically replaces the RAM contents at the address with 'desired' if they still hold
+       'expected'. Backs the exclusive monitor. Only naturally aligned RAM can be used (never IO) */
+    bool compareExchange(uint32_t address, enum FISC_DATATYPE dataType, uint64_t expected, uint64_t desired, bool isLittleEndian, bool debug)
+    {
+        uint64_t oldValue = expected;
+        uint64_t mask = dataTypeSize(dataType) == 8 ? (uint64_t)-1 : (1ull << (dataTypeSize(dataType) * 8)) - 1;
+        return atomicRMW(FISC_ATOMIC_CAS, address, dataType, desired, oldValue, isLittleEndian, debug) && oldValue == (expected & mask);
+    }
+
+    /* Atomic read-modify-write of naturally aligned RAM (never IO), straight on the host's atomics.
+       'operand' is what gets added / swapped in (the desired value of a compare and swap).
+       'oldValue' returns what the memory held before (a compare and swap also takes the expected
+       value through it, and only stores if they match). Returns false if the address can't be used */
+    bool atomicRMW(enum FISC_ATOMIC_OP operation, uint32_t address, enum FISC_DATATYPE dataType, uint64_t operand, uint64_t & oldValue, bool isLittleEndian, bool debug)
+    {
+        if (debug && showExecution)
+            DEBUG(DNORMALH, " (%s @0x%X", operation == FISC_ATOMIC_CAS ? "mcas" : operation == FISC_ATOMIC_ADD ? "madd" : "mswp", address);
+
+        if (!isAddressValid(address, dataType) || !isAddressAligned(address, dataType) || ioconf->isAddressIO(address)) {
+            if (debug && showExecution)
+                DEBUG(DNORMALH, ": INVAL)");
+            return false;
+        }
+
+        bool stored = false;
+        switch (dataType) {
+        case FISC_SZ_8:  stored = atomicRAM<uint8_t>(operation, address, (uint8_t)operand, oldValue, isLittleEndian);   break;
+        case FISC_SZ_16: stored = atomicRAM<uint16_t>(operation, address, (uint16_t)operand, oldValue, isLittleEndian); break;
+        case FISC_SZ_32: stored = atomicRAM<uint32_t>(operation, address, (uint32_t)operand, oldValue, isLittleEndian); break;
+        case FISC_SZ_64: stored = atomicRAM<uint64_t>(operation, address, operand, oldValue, isLittleEndian);           break;
+        default: return false;
+        }
+        if (stored)
+            markPagesWritten(address, dataTypeSize(dataType));
+        if (debug && showExecution)
+            DEBUG(DNORMALH, ": 0x%llX %s)", (unsigned long long)oldValue, stored ? "stored" : "kept");
+        return true;
     }
 
 private:
+    void markPagesWritten(uint32_t address, uint32_t size)
+    {
+        uint32_t lastPage = (uint32_t)(((uint64_t)address + size - 1) / FISC_PAGE_SIZE);
+        for (uint32_t page = address / FISC_PAGE_SIZE; page <= lastPage && page < pageCount; page++)
+            if (pageWriteBitmap[page].load(std::memory_order_relaxed) != ~0u)
+                pageWriteBitmap[page].store(~0u, std::memory_order_release);
+    }
+
+    /* Returns whether the memory got written to */
+    template<typename T>
+    bool atomicRAM(enum FISC_ATOMIC_OP operation, uint32_t address, T operand, uint64_t & oldValue, bool isLittleEndian)
+    {
+        T * ptr = (T*)&mconf->theMemory[address];
+        T previous = (T)oldValue;
+        bool success = true;
+
+        if (isLittleEndian == (HOST_IS_LITTLE_ENDIAN != 0)) {
+            /* The RAM holds the host's byte order: one host atomic does it all */
+            switch (operation) {
+            case FISC_ATOMIC_CAS:  success = atomicCompareExchange<T>(ptr, previous, operand); break;
+            case FISC_ATOMIC_ADD:  previous = atomicFetchAdd<T>(ptr, operand);                break;
+            case FISC_ATOMIC_SWAP: previous = atomicExchange<T>(ptr, operand);                break;
+            default: return false;
+            }
+        }
+        else {
+            /* The RAM holds the other byte order, so everything crosses it byte swapped.
+               The addition can't be done in that order, it needs a compare and swap loop */
+            T current;
+            switch (operation) {
+            case FISC_ATOMIC_CAS:
+                current = byteSwap(previous);
+                success = atomicCompareExchange<T>(ptr, current, byteSwap(operand));
+                previous = byteSwap(current);
+                break;
+            case FISC_ATOMIC_ADD:
+                current = *(volatile T*)ptr;
+                while (!atomicCompareExchange<T>(ptr, current, byteSwap((T)(byteSwap(current) + operand))));
+                previous = byteSwap(current);
+                break;
+            case FISC_ATOMIC_SWAP:
+                previous = byteSwap(atomicExchange<T>(ptr, byteSwap(operand)));
+                break;
+            default: return false;
+            }
+        }
+
+        oldValue = previous;
+        return success;
+    }
+
+    /* The RAM accessors. One host load / store of the right width, byte swapped when the
+       guest data is stored in the other byte order (the text section is big endian) */
+    template<typename T>
+    T readRAM(uint32_t address, bool isLittleEndian)
+    {
+        return loadEndian<T>(&mconf->theMemory[address], isLittleEndian);
+    }
+
+    template<typename T>
+    void writeRAM(uint32_t address, T data, bool isLittleEndian)
+    {
+        storeEndian<T>(&mconf->theMemory[address], data, isLittleEndian);
+    }
+
     uint32_t alignAddress(uint32_t & address, enum FISC_DATATYPE dataType)
     {
         switch (dataType) {
@@ -263,13 +365,24 @@ private:
         return address;
     }
 
+    uint32_t dataTypeSize(enum FISC_DATATYPE dataType)
+    {
+        switch (dataType) {
+            case FISC_SZ_8:  return 1;
+            case FISC_SZ_16: return 2;
+            case FISC_SZ_32: return 4;
+            case FISC_SZ_64: return 8;
+            default:         return 1;
+        }
+    }
+
     bool isAddressValid(uint32_t address, enum FISC_DATATYPE dataType)
     {
         switch (dataType) {
             case FISC_SZ_8: /* Intentional fallthrough */
             case FISC_SZ_16: 
             case FISC_SZ_32:
-            case FISC_SZ_64: return address < mconf->theMemory.size();
+            case FISC_SZ_64: return address < mconf->theMemory.size() && dataTypeSize(dataType) <= mconf->theMemory.size() - address;
             default: return false;
         }
     }
@@ -278,41 +391,41 @@ private:
 #pragma region REGION 4: THE MEMORY BEHAVIOUR (GENERIC VM FUNCTIONS)
 public:
     MemoryModule() : RunPass(MEMORY_MODULE_PRIORITY),
-        showExecution(false)
+        showExecution(false), pageCount(0)
     {
         setWhitelist(WHITELIST_MEM_MOD);
     }
 
     bool loadMemory()
     {
-        mconf->programFile.open();
-        std::string tmpstr;
-
-        /* Load Bootloader program */
-        for (unsigned int i = MEMORY_LOADLOC; i < mconf->getMemSize() && i < mconf->programFile.fileSize(); i++) {
-            tmpstr = mconf->programFile.read(MEMORY_WIDTH / 8);
-            if (tmpstr.size() == 1) {
-                mconf->theBootloaderMemory.push_back(std::bitset<MEMORY_WIDTH>(tmpstr[0]));
-                mconf->loadedProgramSize++;
-            }
-            else {
-                break; /* We've reached EOF */
-            }
+        /* Map the bootloader program instead of reading it in */
+        MappedFile image;
+        if (!image.map(mconf->programFile.fileName)) {
+            DEBUG(DERROR, "Could not map the program '%s' (missing or empty file)", mconf->programFile.fileName.c_str());
+            return false;
         }
-        mconf->programFile.close();
 
-        /* If this is an ELF file instead of a flat binary, then we must parse it and relocate it */
-        if (isFileELF(mconf->programFile) && mconf->loadedProgramSize > 0) {
+        /* Remember what was loaded (the CPU keys its translation cache on it) */
+        mconf->programHash = fnv1a64(image.data(), (size_t)image.size());
+
+        if (isImageELF(image.data(), image.size()) && isFileELF(mconf->programFile)) {
+            /* This is an ELF file instead of a flat binary, so we must parse it and relocate it */
             DEBUG(DINFO, "Program is an ELF object file");
-            if ((mconf->loadedProgramSize = elfToFlatBinary(mconf->theBootloaderMemory, mconf->elfsection_list, ENDIANNESS_TEXTSECT, ENDIANNESS_DATASECT)) == 0) {
-                DEBUG(DERROR, "Could not load the ELF file into memory");
+            if (!elfLoad(mconf->theMemory.data(), mconf->getMemSize(), mconf->elfImage, ENDIANNESS_TEXTSECT, ENDIANNESS_DATASECT)) {
+                DEBUG(DERROR, "Could not load the ELF file into memory (malformed, or a segment lies beyond %llu bytes)", (unsigned long long)mconf->getMemSize());
                 return false;
             }
+            mconf->loadedProgramSize = mconf->elfImage.end;
+            DEBUG(DINFO, "Entry point: 0x%X (%d sections, %d symbols)", mconf->elfImage.entry, (int)mconf->elfImage.sections.size(), (int)mconf->elfImage.symbols.size());
+        }
+        else {
+            /* Flat binary: copy it into the main memory in one go and run it from the start */
+            mconf->elfImage.entry = MEMORY_LOADLOC;
+            mconf->loadedProgramSize = std::min<uint64_t>(image.size(), mconf->getMemSize() - MEMORY_LOADLOC);
+            if (mconf->loadedProgramSize < image.size())
+                DEBUG(DWARN, "The program does not fit in memory. Only the first %llu bytes were loaded", (unsigned long long)mconf->loadedProgramSize);
+            memcpy(mconf->theMemory.data() + MEMORY_LOADLOC, image.data(), (size_t)mconf->loadedProgramSize);
         }
-
-        /* Copy the bootloader memory into the main memory */
-        for(unsigned int i = 0; i < mconf->loadedProgramSize; i++)
-            mconf->theMemory[i] = mconf->theBootloaderMemory[i];
         DEBUG(DINFO, "Loaded %d bytes / %d words into memory", (unsigned int)mconf->loadedProgramSize, (unsigned int)mconf->loadedProgramSize / 4);
         return true;
     }
@@ -336,6 +449,14 @@ public:
             success = PASS_RET_ERR;
         }
 
+        /* No page was written to yet */
+        if (success == PASS_RET_OK) {
+            pageCount = (uint32_t)((mconf->getMemSize() + FISC_PAGE_SIZE - 1) / FISC_PAGE_SIZE);
+            pageWriteBitmap.reset(new std::atomic<uint32_t>[pageCount]);
+            for (uint32_t page = 0; page < pageCount; page++)
+                pageWriteBitmap[page].store(0, std::memory_order_relaxed);
+        }
+
         if (success == PASS_RET_OK) {
             /* Load up the memory */
             if(!loadMemory())
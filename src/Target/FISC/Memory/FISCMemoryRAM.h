@@ -0,0 +1,151 @@
+#ifndef FISCMEMORYRAM_H_
+#define FISCMEMORYRAM_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <mutex>
+#include <vector>
+#else
+#include <sys/mman.h>
+#endif
+
+namespace FISC {
+
+#ifdef _WIN32
+#define GUEST_RAM_COMMIT_CHUNK 0x10000 /* How much gets committed at once on Windows, on the first touch */
+#endif
+
+/* The backing store of the guest's main memory. The whole address range is reserved
+   up front but the host only commits a page the first time the guest touches it, so
+   a large guest costs nothing until it is actually used. Fresh pages read as zero.
+   On Windows the range is only reserved, and a vectored exception handler commits
+   the chunk around the address of the first access violation inside it */
+class GuestRAM {
+public:
+    GuestRAM() : base(nullptr), bytes(0) { }
+
+    ~GuestRAM()
+    {
+        release();
+    }
+
+    GuestRAM(const GuestRAM &) = delete;
+    GuestRAM & operator=(const GuestRAM &) = delete;
+
+    bool reserve(uint64_t size)
+    {
+        release();
+#ifdef _WIN32
+        /* Committing it all here would charge the whole guest against the commit limit */
+        base = (uint8_t*)VirtualAlloc(nullptr, (SIZE_T)size, MEM_RESERVE, PAGE_NOACCESS);
+        if (base)
+            registerRange(this);
+#else
+        void * mem = mmap(nullptr, (size_t)size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        base = mem == MAP_FAILED ? nullptr : (uint8_t*)mem;
+#ifdef MADV_HUGEPAGE
+        /* Fewer host TLB misses on a big guest. Only a hint, so failing is fine */
+        if (base)
+            madvise(base, (size_t)size, MADV_HUGEPAGE);
+#endif
+#endif
+        bytes = base ? size : 0;
+        return base != nullptr;
+    }
+
+    void release()
+    {
+        if (base == nullptr)
+            return;
+#ifdef _WIN32
+        unregisterRange(this);
+        VirtualFree(base, 0, MEM_RELEASE);
+#else
+        munmap(base, (size_t)bytes);
+#endif
+        base = nullptr;
+        bytes = 0;
+    }
+
+    uint8_t * data()
+    {
+        return base;
+    }
+
+    uint64_t size()
+    {
+        return bytes;
+    }
+
+    uint8_t & operator[](uint64_t address)
+    {
+        return base[address];
+    }
+
+private:
+    uint8_t * base;
+    uint64_t  bytes;
+
+#ifdef _WIN32
+    static std::mutex & rangesMutex()
+    {
+        static std::mutex mut;
+        return mut;
+    }
+
+    static std::vector<GuestRAM*> & ranges()
+    {
+        static std::vector<GuestRAM*> list;
+        return list;
+    }
+
+    static void registerRange(GuestRAM * ram)
+    {
+        std::lock_guard<std::mutex> lock(rangesMutex());
+        if (ranges().empty())
+            AddVectoredExceptionHandler(1, commitOnFirstTouch);
+        ranges().push_back(ram);
+    }
+
+    static void unregisterRange(GuestRAM * ram)
+    {
+        std::lock_guard<std::mutex> lock(rangesMutex());
+        for (size_t i = 0; i < ranges().size(); i++) {
+            if (ranges()[i] == ram) {
+                ranges().erase(ranges().begin() + i);
+                break;
+            }
+        }
+        if (ranges().empty())
+            RemoveVectoredExceptionHandler(commitOnFirstTouch);
+    }
+
+    static LONG CALLBACK commitOnFirstTouch(PEXCEPTION_POINTERS info)
+    {
+        if (info->ExceptionRecord->ExceptionCode != EXCEPTION_ACCESS_VIOLATION || info->ExceptionRecord->NumberParameters < 2)
+            return EXCEPTION_CONTINUE_SEARCH;
+
+        uint8_t * address = (uint8_t*)info->ExceptionRecord->ExceptionInformation[1];
+
+        std::lock_guard<std::mutex> lock(rangesMutex());
+        for (GuestRAM * ram : ranges()) {
+            if (address < ram->base || address >= ram->base + ram->bytes)
+                continue;
+
+            /* Commit the chunk holding the address (which is never past the end of the reservation) */
+            uint64_t offset = (uint64_t)(address - ram->base) & ~(uint64_t)(GUEST_RAM_COMMIT_CHUNK - 1);
+            uint64_t length = ram->bytes - offset < GUEST_RAM_COMMIT_CHUNK ? ram->bytes - offset : GUEST_RAM_COMMIT_CHUNK;
+            if (VirtualAlloc(ram->base + offset, (SIZE_T)length, MEM_COMMIT, PAGE_READWRITE) == nullptr)
+                return EXCEPTION_CONTINUE_SEARCH; /* Out of commit: let it crash like any other failed allocation */
+            return EXCEPTION_CONTINUE_EXECUTION;
+        }
+        return EXCEPTION_CONTINUE_SEARCH;
+    }
+#endif
+};
+
+}
+
+#endif
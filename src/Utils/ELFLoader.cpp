@@ -6,6 +6,7 @@
 #include <fvm/Utils/ELFLoader.h>
 #include <iostream>
 #include <algorithm>
+#include <string.h>
 #include <elfio/elfio.hpp>
 
 using namespace ELFIO;
@@ -14,18 +15,6 @@ using namespace ELFIO;
 #define TEXTSECT ".text"
 #define DATASECT ".data"
 
-typedef struct {
-    std::string   name;
-    Elf64_Addr    value;
-    Elf_Xword     size;
-    Elf_Xword     originalSize;
-    int           fixupSizeDifference;
-    unsigned char bind;
-    unsigned char type;
-    Elf_Half      section_index;
-    unsigned char other;
-} symprop_t;
-
 static elfio elfReader;
 static bool isElfReaderInit = false;
 
@@ -42,55 +31,188 @@ bool isFileELF(File & file)
     return true;
 }
 
-uint32_t elfToFlatBinary(std::vector<std::bitset<8> > & loadedELF, elfsection_list_t & elfsection_list, bool textIsLittle, bool dataIsLittle)
+/* Object files have no program headers, so their .text and .data get packed back to back from address 0 */
+static bool packSections(uint8_t * memory, uint64_t memorySize, elfimage_t & image, std::vector<int64_t> & sectionDelta, bool textIsLittle, bool dataIsLittle)
 {
     uint32_t byteCount = 0;
-    uint32_t totalDataByteCount = 0;
-    Elf_Half n = elfReader.sections.size();
-
-    if(n == 0)
-        return byteCount;
 
-    for (Elf_Half i = 1; i < n; i++) {
+    for (Elf_Half i = 1; i < elfReader.sections.size(); i++) {
         section * sect = elfReader.sections[i];
         std::string sectName = sect->get_name();
         const char * data = sect->get_data();
-        if(!data)
+        if (!data || (sectName != TEXTSECT && sectName != DATASECT))
             continue;
-        
-        /* Only care about the following sections (for now) */
-
-        if (sectName == TEXTSECT || sectName == DATASECT) {
-            /* Copy the .text section to the memory as is */
-            for (uint32_t j = 0; j < sect->get_size(); j++)
-                loadedELF[byteCount++] = data[j] & 0xFF;
-
-            if (sectName == TEXTSECT) {
-                elfsection_t textSection;
-                textSection.start = 0;
-                textSection.end = byteCount;
-                textSection.name = TEXTSECT;
-                textSection.isLittleEndian = textIsLittle;
-                elfsection_list.push_back(textSection);
-            }
-            else if (sectName == DATASECT) {
-                for (auto & textSect : elfsection_list) {
-                    if (textSect.name == TEXTSECT) {
-                        elfsection_t dataSection;
-                        dataSection.start = textSect.end;
-                        dataSection.end = byteCount-1;
-                        dataSection.name = DATASECT;
-                        dataSection.isLittleEndian = dataIsLittle;
-                        elfsection_list.push_back(dataSection);
-                        break;
-                    }
-                }
+
+        if (sect->get_size() > 0xFFFFFFFFULL - byteCount)
+            return false;
+        if (memory) {
+            if (byteCount + sect->get_size() > memorySize)
+                return false; /* It doesn't fit */
+            memcpy(memory + byteCount, data, (size_t)sect->get_size());
+        }
+
+        elfsection_t placed;
+        placed.start = byteCount;
+        placed.end = byteCount + (uint32_t)sect->get_size();
+        placed.name = sectName;
+        placed.isLittleEndian = sectName == TEXTSECT ? textIsLittle : dataIsLittle;
+        image.sections.push_back(placed);
+
+        /* Symbol values of object files are relative to their section */
+        sectionDelta[i] = byteCount;
+        byteCount = placed.end;
+    }
+
+    image.entry = 0;
+    image.end = byteCount;
+    return true;
+}
+
+/* Executables and firmware images: every PT_LOAD segment goes to its physical (load) address */
+static bool loadSegments(uint8_t * memory, uint64_t memorySize, elfimage_t & image, std::vector<int64_t> & sectionDelta, bool textIsLittle, bool dataIsLittle)
+{
+    uint64_t end = 0;
+
+    for (Elf_Half i = 0; i < elfReader.segments.size(); i++) {
+        segment * seg = elfReader.segments[i];
+        if (seg->get_type() != PT_LOAD || seg->get_memory_size() == 0)
+            continue;
+
+        uint64_t address  = seg->get_physical_address();
+        uint64_t fileSize = seg->get_file_size();
+        uint64_t memSize  = seg->get_memory_size();
+        if (fileSize > memSize || address + memSize > 0x100000000ULL)
+            return false; /* Malformed, or beyond the 32-bit physical address space */
+
+        if (memory) {
+            if (address + memSize > memorySize)
+                return false; /* It doesn't fit */
+            if (fileSize && seg->get_data())
+                memcpy(memory + address, seg->get_data(), (size_t)fileSize);
+            /* Whatever the file doesn't hold (.bss) starts out as zero */
+            memset(memory + address + fileSize, 0, (size_t)(memSize - fileSize));
+        }
+        end = std::max(end, address + memSize);
+    }
+
+    /* Sections and symbols are linked at virtual addresses. Move them to where their segment was loaded */
+    for (Elf_Half i = 1; i < elfReader.sections.size(); i++) {
+        section * sect = elfReader.sections[i];
+        if (!(sect->get_flags() & SHF_ALLOC) || sect->get_size() == 0)
+            continue;
+
+        int64_t delta = 0;
+        for (Elf_Half j = 0; j < elfReader.segments.size(); j++) {
+            segment * seg = elfReader.segments[j];
+            if (seg->get_type() == PT_LOAD && sect->get_address() >= seg->get_virtual_address() && sect->get_address() < seg->get_virtual_address() + seg->get_memory_size()) {
+                delta = (int64_t)seg->get_physical_address() - (int64_t)seg->get_virtual_address();
+                break;
             }
         }
+
+        elfsection_t placed;
+        placed.start = (uint32_t)(sect->get_address() + delta);
+        placed.end = placed.start + (uint32_t)sect->get_size();
+        placed.name = sect->get_name();
+        placed.isLittleEndian = (sect->get_flags() & SHF_EXECINSTR) ? textIsLittle : dataIsLittle;
+        image.sections.push_back(placed);
+        sectionDelta[i] = delta;
     }
 
-    byteCount += totalDataByteCount;
+    image.entry = (uint32_t)elfReader.get_entry();
+    image.end = (uint32_t)std::min<uint64_t>(end, 0xFFFFFFFFULL);
+    return true;
+}
 
-    /* Return the number of bytes that need to be loaded */
-    return byteCount;
+static void indexSymbols(elfimage_t & image, std::vector<int64_t> & sectionDelta, std::vector<bool> & sectionPlaced)
+{
+    for (Elf_Half i = 1; i < elfReader.sections.size(); i++) {
+        section * sect = elfReader.sections[i];
+        if (sect->get_type() != SHT_SYMTAB)
+            continue;
+
+        symbol_section_accessor symbols(elfReader, sect);
+        for (Elf_Xword j = 0; j < symbols.get_symbols_num(); j++) {
+            std::string   name;
+            Elf64_Addr    value = 0;
+            Elf_Xword     size = 0;
+            unsigned char bind = 0;
+            unsigned char type = 0;
+            Elf_Half      sectionIndex = 0;
+            unsigned char other = 0;
+
+            if (!symbols.get_symbol(j, name, value, size, bind, type, sectionIndex, other) || name.empty())
+                continue;
+            if (type == STT_SECTION || type == STT_FILE || sectionIndex >= sectionPlaced.size() || !sectionPlaced[sectionIndex])
+                continue; /* Not something that was loaded */
+
+            elfsymbol_t symbol;
+            symbol.address = (uint32_t)(value + sectionDelta[sectionIndex]);
+            symbol.size = (uint32_t)size;
+            symbol.name = name;
+            symbol.isFunction = type == STT_FUNC || (elfReader.sections[sectionIndex]->get_flags() & SHF_EXECINSTR);
+            image.symbols.push_back(symbol);
+        }
+    }
+}
+
+bool elfLoad(uint8_t * memory, uint64_t memorySize, elfimage_t & image, bool textIsLittle, bool dataIsLittle)
+{
+    image.entry = image.end = 0;
+    image.sections.clear();
+    image.symbols.clear();
+
+    if (!isElfReaderInit || elfReader.sections.size() == 0)
+        return false;
+
+    bool hasSegments = false;
+    for (Elf_Half i = 0; i < elfReader.segments.size(); i++)
+        if (elfReader.segments[i]->get_type() == PT_LOAD && elfReader.segments[i]->get_memory_size() > 0)
+            hasSegments = true;
+
+    std::vector<int64_t> sectionDelta(elfReader.sections.size(), 0);
+    if (!(hasSegments ? loadSegments(memory, memorySize, image, sectionDelta, textIsLittle, dataIsLittle)
+                      : packSections(memory, memorySize, image, sectionDelta, textIsLittle, dataIsLittle)))
+        return false;
+
+    /* Only the symbols of the sections that made it into memory are of any use */
+    std::vector<bool> sectionPlaced(elfReader.sections.size(), false);
+    for (Elf_Half i = 1; i < elfReader.sections.size(); i++) {
+        section * sect = elfReader.sections[i];
+        sectionPlaced[i] = hasSegments ? (sect->get_flags() & SHF_ALLOC) && sect->get_size() > 0
+                                       : sect->get_data() && (sect->get_name() == TEXTSECT || sect->get_name() == DATASECT);
+    }
+    indexSymbols(image, sectionDelta, sectionPlaced);
+
+    std::sort(image.sections.begin(), image.sections.end(), [](const elfsection_t & a, const elfsection_t & b) { return a.start < b.start; });
+    std::sort(image.symbols.begin(), image.symbols.end(), [](const elfsymbol_t & a, const elfsymbol_t & b) { return a.address < b.address; });
+    return true;
+}
+
+const elfsection_t * elfFindSection(const elfimage_t & image, uint32_t address)
+{
+    /* The last section that starts at or before the address */
+    auto it = std::upper_bound(image.sections.begin(), image.sections.end(), address, [](uint32_t addr, const elfsection_t & s) { return addr < s.start; });
+    if (it == image.sections.begin())
+        return nullptr;
+    --it;
+    return address < it->end ? &*it : nullptr;
+}
+
+const elfsymbol_t * elfFindSymbol(const elfimage_t & image, uint32_t address)
+{
+    /* The last symbol that starts at or before the address. Symbols without a size (plain labels) cover everything up to the next one */
+    auto it = std::upper_bound(image.symbols.begin(), image.symbols.end(), address, [](uint32_t addr, const elfsymbol_t & s) { return addr < s.address; });
+    if (it == image.symbols.begin())
+        return nullptr;
+    --it;
+    return it->size == 0 || address - it->address < it->size ? &*it : nullptr;
+}
+
+const elfsymbol_t * elfFindSymbol(const elfimage_t & image, std::string name)
+{
+    for (auto & symbol : image.symbols)
+        if (symbol.name == name)
+            return &symbol;
+    return nullptr;
 }
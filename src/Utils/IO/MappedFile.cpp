@@ -0,0 +1,110 @@
+#include <fvm/Utils/IO/MappedFile.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : base(nullptr), bytes(0)
+#ifdef _WIN32
+	, fileHandle(nullptr), mappingHandle(nullptr)
+#endif
+{
+
+}
+
+MappedFile::~MappedFile()
+{
+	unmap();
+}
+
+bool MappedFile::map(std::string fileName)
+{
+	unmap();
+#ifdef _WIN32
+	HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		CloseHandle(file);
+		return false;
+	}
+
+	void * view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!view) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	mappingHandle = mapping;
+	base = (const uint8_t*)view;
+	bytes = (uint64_t)fileSize.QuadPart;
+#else
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		::close(fd);
+		return false;
+	}
+
+	/* The mapping holds its own reference to the file, so the descriptor can go right away */
+	void * view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (view == MAP_FAILED)
+		return false;
+
+	/* The loader reads the file once from start to end */
+	madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+	base = (const uint8_t*)view;
+	bytes = (uint64_t)st.st_size;
+#endif
+	return true;
+}
+
+void MappedFile::unmap()
+{
+	if (!base)
+		return;
+#ifdef _WIN32
+	UnmapViewOfFile(base);
+	CloseHandle((HANDLE)mappingHandle);
+	CloseHandle((HANDLE)fileHandle);
+	fileHandle = mappingHandle = nullptr;
+#else
+	munmap((void*)base, (size_t)bytes);
+#endif
+	base = nullptr;
+	bytes = 0;
+}
+
+bool MappedFile::isMapped()
+{
+	return base != nullptr;
+}
+
+const uint8_t * MappedFile::data()
+{
+	return base;
+}
+
+uint64_t MappedFile::size()
+{
+	return bytes;
+}